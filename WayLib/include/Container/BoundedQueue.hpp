@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "Container/WaitStrategy.hpp"
+
+namespace WayLib {
+    // Bounded multi producer, multi consumer queue on a ring of slots (Vyukov's design), a lock-free counterpart of
+    // ThreadSafeQueue with emplace / push / tryPull / pull / tryVisit / visit. Unlike ThreadSafeQueue it cannot be
+    // closed: pull returns the value itself and visit always visits one, both wait as long as it takes. Every slot
+    // carries a sequence number that says whose turn it is, so a push or pull is one CAS on a ring index plus a store,
+    // and producers and consumers only meet on the slot they hand over.
+    // The ring never grows: tryEmplace / tryPush fail when it is full, emplace / push wait for room, which is the
+    // backpressure on producers. How threads wait is up to WaitStrategy (SpinWait, BlockingWait or HybridWait).
+    template<typename T, typename WaitStrategy = HybridWait>
+    class BoundedQueue {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "values are moved in and out of claimed slots");
+
+        struct Slot {
+            std::atomic<size_t> m_Sequence;
+            alignas(T) std::byte m_Storage[sizeof(T)];
+
+            T *value() {
+                return std::launder(reinterpret_cast<T *>(m_Storage));
+            }
+        };
+
+        size_t m_Mask;
+        std::unique_ptr<Slot[]> m_Slots;
+
+        // producers claim at the tail, consumers at the head, each index on its own cache line
+        alignas(64) std::atomic<size_t> m_Tail{};
+        alignas(64) std::atomic<size_t> m_Head{};
+        alignas(64) WaitStrategy m_NotEmpty;
+        alignas(64) WaitStrategy m_NotFull;
+
+    public:
+        using value_type = T;
+
+        // the capacity is rounded up to a power of two
+        explicit BoundedQueue(size_t capacity) : m_Mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1},
+                                                 m_Slots{std::make_unique<Slot[]>(m_Mask + 1)} {
+            for (size_t i = 0; i <= m_Mask; ++i) {
+                m_Slots[i].m_Sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // no other thread may still be using the queue
+        ~BoundedQueue() {
+            while (tryPull()) {}
+        }
+
+        bool tryEmplace(auto &&... args) {
+            if constexpr (std::is_nothrow_constructible_v<T, decltype(args)...>) {
+                return tryClaim([&](Slot &slot) {
+                    ::new(slot.m_Storage) T(std::forward<decltype(args)>(args)...);
+                });
+            } else {
+                // a throwing constructor must not leave a claimed slot behind, so the value is built first
+                T value(std::forward<decltype(args)>(args)...);
+                return tryClaim([&](Slot &slot) {
+                    ::new(slot.m_Storage) T(std::move(value));
+                });
+            }
+        }
+
+        bool tryPush(T &&data) {
+            return tryEmplace(std::move(data));
+        }
+
+        bool tryPush(const T &data) {
+            return tryEmplace(data);
+        }
+
+        // waits while the queue is full
+        void emplace(auto &&... args) {
+            if constexpr (std::is_nothrow_constructible_v<T, decltype(args)...>) {
+                claim([&](Slot &slot) {
+                    ::new(slot.m_Storage) T(std::forward<decltype(args)>(args)...);
+                });
+            } else {
+                T value(std::forward<decltype(args)>(args)...);
+                claim([&](Slot &slot) {
+                    ::new(slot.m_Storage) T(std::move(value));
+                });
+            }
+        }
+
+        void push(T &&data) {
+            this->emplace(std::move(data));
+        }
+
+        void push(const T &data) {
+            this->emplace(data);
+        }
+
+        std::optional<T> tryPull() {
+            std::optional<T> result;
+            size_t position = m_Head.load(std::memory_order_relaxed);
+            while (true) {
+                Slot &slot = m_Slots[position & m_Mask];
+                size_t sequence = slot.m_Sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                if (diff == 0) {
+                    if (m_Head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        result.emplace(std::move(*slot.value()));
+                        std::destroy_at(slot.value());
+                        // the slot is free for the producer one lap later
+                        slot.m_Sequence.store(position + m_Mask + 1, std::memory_order_release);
+                        m_NotFull.notify();
+                        return result;
+                    }
+                } else if (diff < 0) {
+                    return result;
+                } else {
+                    position = m_Head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // waits while the queue is empty
+        T pull() {
+            while (true) {
+                if (auto result = tryPull()) {
+                    return std::move(*result);
+                }
+                m_NotEmpty.wait([this] { return readable(); });
+            }
+        }
+
+        bool tryVisit(auto &&visitor) {
+            auto result = tryPull();
+            if (!result) {
+                return false;
+            }
+            std::invoke(visitor, std::move(*result));
+            return true;
+        }
+
+        void visit(auto &&visitor) {
+            std::invoke(visitor, pull());
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return m_Mask + 1;
+        }
+
+        // a snapshot, concurrent pushes and pulls may already have changed it
+        [[nodiscard]] size_t size() const {
+            size_t head = m_Head.load(std::memory_order_acquire);
+            size_t tail = m_Tail.load(std::memory_order_acquire);
+            return tail > head ? std::min(tail - head, capacity()) : 0;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return !readable();
+        }
+
+    private:
+        // claims the tail slot if it is free and constructs into it, false when the ring is full
+        bool tryClaim(auto &&construct) {
+            size_t position = m_Tail.load(std::memory_order_relaxed);
+            while (true) {
+                Slot &slot = m_Slots[position & m_Mask];
+                size_t sequence = slot.m_Sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+                if (diff == 0) {
+                    if (m_Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        construct(slot);
+                        slot.m_Sequence.store(position + 1, std::memory_order_release);
+                        m_NotEmpty.notify();
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    position = m_Tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void claim(auto &&construct) {
+            while (!tryClaim(construct)) {
+                m_NotFull.wait([this] { return writable(); });
+            }
+        }
+
+        // The slot at the head holds a value. A slot already a lap ahead means the head moved on since it was read,
+        // that counts as readable too so a waiter retries instead of sleeping on a stale head.
+        bool readable() const {
+            size_t position = m_Head.load(std::memory_order_acquire);
+            size_t sequence = m_Slots[position & m_Mask].m_Sequence.load(std::memory_order_acquire);
+            return static_cast<std::ptrdiff_t>(sequence - (position + 1)) >= 0;
+        }
+
+        // the slot at the tail is free, or the tail moved on since it was read
+        bool writable() const {
+            size_t position = m_Tail.load(std::memory_order_acquire);
+            size_t sequence = m_Slots[position & m_Mask].m_Sequence.load(std::memory_order_acquire);
+            return static_cast<std::ptrdiff_t>(sequence - position) >= 0;
+        }
+    };
+}
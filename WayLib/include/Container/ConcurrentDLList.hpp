@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "Container/EpochReclaimer.hpp"
+#include "Container/NodePool.hpp"
+
+namespace WayLib {
+    // Lock-free multi producer, multi consumer list with emplaceBack / popFront (a Michael-Scott queue). Nodes that
+    // consumers have unlinked are freed through Impl::EpochReclaimer, so a thread that is still looking at one never
+    // reads freed memory, and values live inline in nodes from Impl::NodePool.
+    // emplaceBackShared also returns a Node handle, a reference counted pointer to the element that stays valid after
+    // the element is popped, like a shared_ptr; the value is then copied out by popFront instead of moved, and is
+    // read-only through the handle.
+    template<typename T>
+    class ConcurrentDLList {
+        struct Link {
+            std::atomic<Link *> m_Next{};
+            // one for the list, one per Node handle
+            std::atomic<uint32_t> m_References{1};
+            bool m_HasValue{};
+            alignas(T) std::byte m_Storage[sizeof(T)];
+
+            T *value() {
+                return std::launder(reinterpret_cast<T *>(m_Storage));
+            }
+        };
+
+        using Pool = Impl::NodePool<sizeof(Link), alignof(Link)>;
+
+        // head is a dummy whose successor is the first element, both ends on their own cache lines
+        alignas(64) std::atomic<Link *> m_Head;
+        alignas(64) std::atomic<Link *> m_Tail;
+        alignas(64) std::atomic<size_t> m_Size{};
+
+    public:
+        using value_type = T;
+
+        class Node {
+            Link *m_Link{};
+
+            friend class ConcurrentDLList;
+
+            explicit Node(Link *link) : m_Link{link} {
+                m_Link->m_References.fetch_add(1, std::memory_order_relaxed);
+            }
+
+        public:
+            Node() = default;
+
+            Node(const Node &rhs) : m_Link{rhs.m_Link} {
+                if (m_Link) {
+                    m_Link->m_References.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            Node(Node &&rhs) noexcept : m_Link{std::exchange(rhs.m_Link, nullptr)} {}
+
+            Node &operator=(Node rhs) noexcept {
+                std::swap(m_Link, rhs.m_Link);
+                return *this;
+            }
+
+            ~Node() {
+                if (m_Link) {
+                    Release(m_Link);
+                }
+            }
+
+            explicit operator bool() const {
+                return m_Link;
+            }
+
+            const T &operator*() const {
+                return *m_Link->value();
+            }
+
+            const T *operator->() const {
+                return m_Link->value();
+            }
+
+            const T &getValue() const {
+                return *m_Link->value();
+            }
+
+            // another handle on the same element
+            Node share() const {
+                return *this;
+            }
+        };
+
+        ConcurrentDLList() {
+            Link *dummy = NewLink();
+            m_Head.store(dummy, std::memory_order_relaxed);
+            m_Tail.store(dummy, std::memory_order_relaxed);
+        }
+
+        ConcurrentDLList(const ConcurrentDLList &) = delete;
+
+        ConcurrentDLList &operator=(const ConcurrentDLList &) = delete;
+
+        // no other thread may still be using the list
+        ~ConcurrentDLList() {
+            Link *link = m_Head.load(std::memory_order_relaxed);
+            while (link) {
+                Link *next = link->m_Next.load(std::memory_order_relaxed);
+                Release(link);
+                link = next;
+            }
+        }
+
+        void emplaceBack(auto &&... args) {
+            enqueue(NewLink(std::forward<decltype(args)>(args)...));
+        }
+
+        void pushBack(auto &&value) {
+            emplaceBack(std::forward<decltype(value)>(value));
+        }
+
+        Node emplaceBackShared(auto &&... args) {
+            static_assert(std::is_copy_constructible_v<T>, "shared elements are copied out by popFront");
+            Link *link = NewLink(std::forward<decltype(args)>(args)...);
+            Node node(link);
+            enqueue(link);
+            return node;
+        }
+
+        std::optional<T> popFront() {
+            Impl::EpochReclaimer::Guard guard;
+            while (true) {
+                Link *head = m_Head.load(std::memory_order_acquire);
+                Link *tail = m_Tail.load(std::memory_order_acquire);
+                Link *next = head->m_Next.load(std::memory_order_acquire);
+                if (head != m_Head.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                if (!next) {
+                    return std::nullopt;
+                }
+                if (head == tail) {
+                    // a producer linked next but has not moved the tail yet
+                    m_Tail.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                if (m_Head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    // next is the new dummy, its value belongs to this thread alone
+                    std::optional<T> result = takeValue(next);
+                    m_Size.fetch_sub(1, std::memory_order_relaxed);
+                    Impl::EpochReclaimer::Retire(head, [](void *link) {
+                        Release(static_cast<Link *>(link));
+                    });
+                    return result;
+                }
+            }
+        }
+
+        [[nodiscard]] bool empty() const {
+            Impl::EpochReclaimer::Guard guard;
+            return !m_Head.load(std::memory_order_acquire)->m_Next.load(std::memory_order_acquire);
+        }
+
+        // a snapshot, concurrent pushes and pops may already have changed it
+        [[nodiscard]] size_t size() const {
+            return m_Size.load(std::memory_order_relaxed);
+        }
+
+    private:
+        template<typename... Args>
+        static Link *NewLink(Args &&... args) {
+            void *memory = Pool::Allocate();
+            auto *link = ::new(memory) Link;
+            if constexpr (sizeof...(Args) > 0) {
+                try {
+                    ::new(link->m_Storage) T(std::forward<Args>(args)...);
+                } catch (...) {
+                    link->~Link();
+                    Pool::Deallocate(memory);
+                    throw;
+                }
+                link->m_HasValue = true;
+            }
+            return link;
+        }
+
+        static void Release(Link *link) {
+            if (link->m_References.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if (link->m_HasValue) {
+                    std::destroy_at(link->value());
+                }
+                link->~Link();
+                Pool::Deallocate(link);
+            }
+        }
+
+        static std::optional<T> takeValue(Link *link) {
+            if constexpr (std::is_copy_constructible_v<T>) {
+                // handles may still read the value
+                if (link->m_References.load(std::memory_order_acquire) > 1) {
+                    return *link->value();
+                }
+            }
+            return std::move(*link->value());
+        }
+
+        void enqueue(Link *link) {
+            m_Size.fetch_add(1, std::memory_order_relaxed);
+            Impl::EpochReclaimer::Guard guard;
+            while (true) {
+                Link *tail = m_Tail.load(std::memory_order_acquire);
+                Link *next = tail->m_Next.load(std::memory_order_acquire);
+                if (tail != m_Tail.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                if (next) {
+                    // help a producer that linked its node but has not moved the tail yet
+                    m_Tail.compare_exchange_strong(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                    continue;
+                }
+                if (tail->m_Next.compare_exchange_weak(next, link, std::memory_order_release,
+                                                       std::memory_order_relaxed)) {
+                    m_Tail.compare_exchange_strong(tail, link, std::memory_order_release, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    };
+}
@@ -1,225 +1,172 @@
 #pragma once
 #include <algorithm>
-#include <memory>
-#include <vector>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "Container/NodePool.hpp"
 #include "Util/DataBuffer.hpp"
 #include "Util/Stream.hpp"
 #include "Util/StreamUtil.hpp"
 
 namespace WayLib {
+    // Values are stored inline in the nodes and the nodes come from a slab pool (Impl::NodePool), so an element costs
+    // one pooled block and walking the list touches nothing but the nodes. Iterators and node handles are plain
+    // pointers, nothing is reference counted; use DLList<std::shared_ptr<T>> when the values need shared ownership.
     template<typename T>
     class DLList : public inject_container_traits<DLList, T> {
-        class Node;
-        std::shared_ptr<Node> m_Head;
-        std::weak_ptr<Node> m_Tail;
+        struct Link {
+            Link *m_Next{};
+            Link *m_Prev{};
+            T m_Value;
 
-        size_t m_Size{};
-
-        friend class Node;
+            template<typename... Args>
+            explicit Link(Args &&... args) : m_Value(std::forward<Args>(args)...) {}
+        };
 
-    public:
-        using value_type = T;
+        using Pool = Impl::NodePool<sizeof(Link), alignof(Link)>;
 
-        std::shared_ptr<Node> getHead() const {
-            return m_Head;
-        }
+        Link *m_Head{};
+        Link *m_Tail{};
 
-        std::shared_ptr<Node> getTail() const {
-            return m_Tail.lock();
-        }
+        size_t m_Size{};
 
     public:
-        // primitive operations for CRTP
-        [[nodiscard]] size_t size() const {
-            return m_Size;
-        }
-
-        // begin, end, erase
-        decltype(auto) push(this auto &&self, auto &&item) {
-            self.insertBack(std::make_shared<T>(std::forward<decltype(item)>(item)));
-            return std::forward<decltype(self)>(self);
-        }
-
-        decltype(auto) emplace(this auto &&self, auto &&... args) {
-            self.insertBack(std::make_shared<T>(std::forward<decltype(args)>(args)...));
-            return std::forward<decltype(self)>(self);
-        }
-
-        decltype(auto) resize(this auto &&self, size_t n) {
-            if (self.size() > n) {
-                auto it = self.begin();
-                std::advance(it, n);
-                self.erase(it, self.end());
-            }
-        }
-
-        decltype(auto) setData(this auto &&self, DLList &&data) {
-            self = std::move(data);
-        }
+        using value_type = T;
 
-    private:
+        // Handle on one node, a node pointer plus a list pointer. It stays valid until its node is popped or erased,
+        // whatever happens to the rest of the list, and the list may be moved in the meantime only if the handle is
+        // not used to insert or pop afterwards.
         class Node {
-            std::shared_ptr<Node> m_Next;
-            std::weak_ptr<Node> m_Prev;
-            std::shared_ptr<T> m_Value;
-            DLList<T> *m_List;
+            Link *m_Link{};
+            DLList *m_List{};
 
             friend class DLList;
 
+            Node(Link *link, DLList *list) : m_Link{link}, m_List{list} {}
+
         public:
-            explicit Node(DLList<T> *list) : m_List{list} {
-                ++(m_List->m_Size);
-            }
+            Node() = default;
 
-            std::shared_ptr<T> &getPtr() {
-                return m_Value;
+            explicit operator bool() const {
+                return m_Link;
             }
 
-            const std::shared_ptr<T> &getPtr() const {
-                return m_Value;
+            T &operator*() const {
+                return m_Link->m_Value;
             }
 
-            T &operator*() {
-                return *m_Value;
+            T *operator->() const {
+                return &m_Link->m_Value;
             }
 
-            const T &operator*() const {
-                return *m_Value;
+            T &getValue() const {
+                return m_Link->m_Value;
             }
 
-            T &getValue() {
-                return *m_Value;
+            Node getNext() const {
+                return {m_Link->m_Next, m_List};
             }
 
-            const T &getValue() const {
-                return *m_Value;
+            Node getPrev() const {
+                return {m_Link->m_Prev, m_List};
             }
 
-            std::shared_ptr<T> pop() {
-                auto node = getThis();
-                if (auto prev = m_Prev.lock()) {
-                    prev->m_Next = m_Next;
-                } else {
-                    m_List->m_Head = m_Next;
-                }
-
-                if (m_Next) {
-                    m_Next->m_Prev = m_Prev;
-                } else {
-                    m_List->m_Tail = m_Prev.lock();
-                }
-
-                --(m_List->m_Size);
+            Node insertAfter(auto &&value) const {
+                return emplaceAfter(std::forward<decltype(value)>(value));
+            }
 
-                return node->m_Value;
+            Node insertBefore(auto &&value) const {
+                return emplaceBefore(std::forward<decltype(value)>(value));
             }
 
-        private:
-            std::shared_ptr<Node> getThis() const {
-                if (m_Prev.lock()) {
-                    return m_Prev.lock()->m_Next;
-                } else {
-                    return m_List->m_Head;
-                }
+            Node emplaceAfter(auto &&... args) const {
+                return {m_List->linkBefore(m_Link->m_Next, MakeLink(std::forward<decltype(args)>(args)...)), m_List};
             }
 
-        public:
-            std::shared_ptr<Node> share() const {
-                return getThis();
+            Node emplaceBefore(auto &&... args) const {
+                return {m_List->linkBefore(m_Link, MakeLink(std::forward<decltype(args)>(args)...)), m_List};
             }
 
-            std::shared_ptr<Node> getNext() const {
-                return m_Next;
+            // unlinks and frees the node, its value is moved out; the handle must not be used afterwards
+            T pop() const {
+                return m_List->take(m_Link);
             }
 
-            std::shared_ptr<Node> getPrev() const {
-                return m_Prev.lock();
+            bool operator==(const Node &other) const {
+                return m_Link == other.m_Link;
             }
+        };
 
-            std::shared_ptr<Node> insertAfter(const std::shared_ptr<T> &value) {
-                auto newNode = std::make_shared<Node>(m_List);
-                newNode->m_Value = value;
-                newNode->m_Next = m_Next;
-                newNode->m_Prev = getThis();
-                m_Next = newNode;
-                if (newNode->m_Next) {
-                    newNode->m_Next->m_Prev = newNode;
-                } else {
-                    m_List->m_Tail = newNode;
-                }
+        Node getHead() {
+            return {m_Head, this};
+        }
 
-                return newNode;
-            }
+        Node getTail() {
+            return {m_Tail, this};
+        }
 
-            std::shared_ptr<Node> insertBefore(const std::shared_ptr<T> &value) {
-                auto newNode = std::make_shared<Node>(m_List);
-                newNode->m_Value = value;
-                newNode->m_Prev = m_Prev;
-                newNode->m_Next = getThis();
-                if (auto prev = m_Prev.lock()) {
-                    prev->m_Next = newNode;
-                } else {
-                    m_List->m_Head = newNode;
-                }
-                m_Prev = newNode;
+    public:
+        // primitive operations for CRTP
+        [[nodiscard]] size_t size() const {
+            return m_Size;
+        }
 
-                return newNode;
-            }
+        // begin, end, erase
+        decltype(auto) push(this auto &&self, auto &&item) {
+            self.emplaceBack(std::forward<decltype(item)>(item));
+            return std::forward<decltype(self)>(self);
+        }
 
-            std::shared_ptr<Node> emplaceAfter(auto &&... args) {
-                return insertAfter(std::make_shared<T>(std::forward<decltype(args)>(args)...));
-            }
+        decltype(auto) emplace(this auto &&self, auto &&... args) {
+            self.emplaceBack(std::forward<decltype(args)>(args)...);
+            return std::forward<decltype(self)>(self);
+        }
 
-            std::shared_ptr<Node> emplaceBefore(auto &&... args) {
-                return std::make_shared<T>(std::forward<decltype(args)>(args)...);
+        decltype(auto) resize(this auto &&self, size_t n) {
+            if (self.size() > n) {
+                auto it = self.begin();
+                std::advance(it, n);
+                self.erase(it, self.end());
             }
+        }
 
-            ~Node() = default;
-        };
+        decltype(auto) setData(this auto &&self, DLList &&data) {
+            self = std::move(data);
+        }
 
-    public:
-        std::shared_ptr<Node> insertFront(const std::shared_ptr<T> value) {
-            if (this->size()) {
-                return this->m_Head->insertBefore(value);
-            } else {
-                this->m_Head = std::make_shared<Node>(this);
-                this->m_Head->m_Value = value;
-                this->m_Tail = this->m_Head;
-                return this->m_Head;
-            }
+        Node insertFront(auto &&value) {
+            return emplaceFront(std::forward<decltype(value)>(value));
         }
 
-        std::shared_ptr<Node> insertBack(const std::shared_ptr<T> value) {
-            if (this->size()) {
-                return this->getTail()->insertAfter(value);
-            } else {
-                this->m_Head = std::make_shared<Node>(this);
-                this->m_Head->m_Value = value;
-                this->m_Tail = this->m_Head;
-                return this->m_Head;
-            }
+        Node insertBack(auto &&value) {
+            return emplaceBack(std::forward<decltype(value)>(value));
         }
 
-        std::shared_ptr<Node> emplaceFront(auto &&... args) {
-            return insertFront(std::make_shared<T>(std::forward<decltype(args)>(args)...));
+        Node emplaceFront(auto &&... args) {
+            return {linkBefore(m_Head, MakeLink(std::forward<decltype(args)>(args)...)), this};
         }
 
-        std::shared_ptr<Node> emplaceBack(auto &&... args) {
-            return insertBack(std::make_shared<T>(std::forward<decltype(args)>(args)...));
+        Node emplaceBack(auto &&... args) {
+            return {linkBefore(nullptr, MakeLink(std::forward<decltype(args)>(args)...)), this};
         }
 
-        std::shared_ptr<T> popFront() {
-            if (this->size()) {
-                return this->m_Head->pop();
+        std::optional<T> popFront() {
+            if (m_Head) {
+                return take(m_Head);
             }
-            return nullptr;
+            return std::nullopt;
         }
 
-        std::shared_ptr<T> popBack() {
-            if (this->size()) {
-                return this->getTail()->pop();
+        std::optional<T> popBack() {
+            if (m_Tail) {
+                return take(m_Tail);
             }
-            return nullptr;
+            return std::nullopt;
         }
 
         [[nodiscard]] bool empty() const {
@@ -227,133 +174,247 @@ namespace WayLib {
         }
 
         // Iterator
-        class Iterator {
-            std::shared_ptr<Node> m_Node;
-
-        public:
-            explicit Iterator(const std::shared_ptr<Node> &node) : m_Node{node} {}
+        template<bool Const>
+        class BasicIterator {
+            using ListType = std::conditional_t<Const, const DLList, DLList>;
 
-            Iterator() = default;
-
-            operator bool() const {
-                return m_Node;
-            }
+            Link *m_Link{};
+            ListType *m_List{};
 
-            T &operator*() {
-                return this->getValue();
-            }
+            friend class DLList;
+            friend class BasicIterator<!Const>;
 
-            const T &operator*() const {
-                return this->getValue();
-            }
+            BasicIterator(Link *link, ListType *list) : m_Link{link}, m_List{list} {}
 
-            T &getValue() {
-                return m_Node->getValue();
-            }
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T *, T *>;
+            using reference = std::conditional_t<Const, const T &, T &>;
 
-            const T &getValue() const {
-                return m_Node->getValue();
-            }
+            BasicIterator() = default;
 
-            std::shared_ptr<Node> getNode() const {
-                return m_Node;
-            }
+            template<bool IsConst = Const> requires IsConst
+            BasicIterator(const BasicIterator<false> &other) : m_Link{other.m_Link}, m_List{other.m_List} {}
 
-            Node *operator->() const {
-                return m_Node.get();
+            explicit operator bool() const {
+                return m_Link;
             }
 
-            bool operator==(const Iterator &other) const {
-                return m_Node.get() == other.m_Node.get();
+            reference operator*() const {
+                return m_Link->m_Value;
             }
 
-            bool operator!=(const Iterator &other) const {
-                return !(*this == other);
+            pointer operator->() const {
+                return &m_Link->m_Value;
             }
 
-            operator T &() {
-                return *m_Node->getPtr();
+            reference getValue() const {
+                return m_Link->m_Value;
             }
 
-            operator const T &() const {
-                return *m_Node->getPtr();
+            Node getNode() const requires (!Const) {
+                return MakeNode(m_Link, m_List);
             }
 
-            operator std::shared_ptr<T> &() {
-                return m_Node->getPtr();
+            operator reference() const {
+                return m_Link->m_Value;
             }
 
-            operator const std::shared_ptr<T> &() const {
-                return m_Node->getPtr();
+            bool operator==(const BasicIterator &other) const {
+                return m_Link == other.m_Link;
             }
 
-            Iterator &operator++() {
-                m_Node = m_Node->getNext();
+            BasicIterator &operator++() {
+                m_Link = m_Link->m_Next;
                 return *this;
             }
 
-            Iterator operator++(int) {
+            BasicIterator operator++(int) {
                 auto copy = *this;
                 ++(*this);
                 return copy;
             }
 
-            Iterator &operator--() {
-                m_Node = m_Node->getPrev();
+            // end() steps back onto the tail
+            BasicIterator &operator--() {
+                m_Link = m_Link ? m_Link->m_Prev : m_List->m_Tail;
                 return *this;
             }
 
-            Iterator operator--(int) {
+            BasicIterator operator--(int) {
                 auto copy = *this;
                 --(*this);
                 return copy;
             }
         };
 
-        Iterator begin() const {
-            return Iterator{this->getHead()};
+        using Iterator = BasicIterator<false>;
+        using ConstIterator = BasicIterator<true>;
+
+        Iterator begin() {
+            return {m_Head, this};
+        }
+
+        Iterator end() {
+            return {nullptr, this};
+        }
+
+        ConstIterator begin() const {
+            return {m_Head, this};
+        }
+
+        ConstIterator end() const {
+            return {nullptr, this};
+        }
+
+        auto rbegin() {
+            return std::reverse_iterator<Iterator>(end());
+        }
+
+        auto rend() {
+            return std::reverse_iterator<Iterator>(begin());
+        }
+
+        auto rbegin() const {
+            return std::reverse_iterator<ConstIterator>(end());
+        }
+
+        auto rend() const {
+            return std::reverse_iterator<ConstIterator>(begin());
+        }
+
+        // returns the iterator after the erased element
+        Iterator erase(const Iterator &it) {
+            Link *next = it.m_Link->m_Next;
+            unlink(it.m_Link);
+            FreeLink(it.m_Link);
+            return {next, this};
+        }
+
+        // cuts the range out with one relink, then frees its nodes
+        Iterator erase(const Iterator &begin, const Iterator &end) {
+            if (begin == end) {
+                return end;
+            }
+            Link *first = begin.m_Link;
+            Link *before = first->m_Prev;
+            (before ? before->m_Next : m_Head) = end.m_Link;
+            (end.m_Link ? end.m_Link->m_Prev : m_Tail) = before;
+            for (Link *link = first; link != end.m_Link;) {
+                Link *next = link->m_Next;
+                FreeLink(link);
+                --m_Size;
+                link = next;
+            }
+            return {end.m_Link, this};
         }
 
-        Iterator end() const {
-            return Iterator{nullptr};
+        // Moves [first, last) of other in front of position, relinking the nodes in O(1); count must be the length
+        // of the range (it is ignored when other is this list). Iterators and handles on the moved elements keep
+        // their nodes but still name other, so get new ones from this list before inserting or popping through them.
+        void spliceRange(const Iterator &position, DLList &other, const Iterator &first, const Iterator &last,
+                         size_t count) {
+            if (first == last || (&other == this && (position == first || position == last))) {
+                return;
+            }
+            Link *front = first.m_Link;
+            Link *back = last.m_Link ? last.m_Link->m_Prev : other.m_Tail;
+            Link *before = front->m_Prev;
+            (before ? before->m_Next : other.m_Head) = last.m_Link;
+            (last.m_Link ? last.m_Link->m_Prev : other.m_Tail) = before;
+            other.m_Size -= count;
+
+            Link *next = position.m_Link;
+            Link *prev = next ? next->m_Prev : m_Tail;
+            front->m_Prev = prev;
+            back->m_Next = next;
+            (prev ? prev->m_Next : m_Head) = front;
+            (next ? next->m_Prev : m_Tail) = back;
+            m_Size += count;
         }
 
-        Iterator rbegin() const {
-            return Iterator{this->getTail()};
+        // counts the range first, O(n) unless other is this list
+        void spliceRange(const Iterator &position, DLList &other, const Iterator &first, const Iterator &last) {
+            spliceRange(position, other, first, last, &other == this ? 0 : std::distance(first, last));
         }
 
-        Iterator rend() const {
-            return Iterator{nullptr};
+        void splice(const Iterator &position, DLList &other) {
+            if (&other != this) {
+                spliceRange(position, other, other.begin(), other.end(), other.m_Size);
+            }
         }
 
-        static void erase(const Iterator &it) {
-            it.getNode()->remove();
+        void splice(const Iterator &position, DLList &&other) {
+            splice(position, other);
         }
 
-        void erase(const Iterator &begin, const Iterator &end) {
-            for (auto it = begin; it != end; ++it) {
-                erase(it);
+        void splice(const Iterator &position, DLList &other, const Iterator &it) {
+            spliceRange(position, other, it, std::next(it), 1);
+        }
+
+        // Merges other, sorted by comparator, into this list, also sorted; other ends up empty. Stable, elements of
+        // this list come before equal ones of other, and no node is allocated or value moved.
+        decltype(auto) merge(this auto &&self, DLList &other, auto &&comparator) {
+            if (&other != &self) {
+                self.m_Tail = other.m_Tail = nullptr;
+                self.m_Head = MergeChains(self.m_Head, std::exchange(other.m_Head, nullptr), comparator);
+                self.m_Size += std::exchange(other.m_Size, 0);
+                self.relinkBackward();
             }
+            return std::forward<decltype(self)>(self);
+        }
+
+        decltype(auto) merge(this auto &&self, DLList &other) {
+            return std::forward<decltype(self)>(self).merge(other, std::less<>{});
         }
 
         void clear() {
-            m_Head.reset();
-            m_Tail.reset();
+            for (Link *link = m_Head; link;) {
+                Link *next = link->m_Next;
+                FreeLink(link);
+                link = next;
+            }
+            m_Head = m_Tail = nullptr;
             m_Size = 0;
         }
 
         DLList() = default;
 
-        DLList(std::initializer_list<std::shared_ptr<T> > list) {
+        DLList(std::initializer_list<T> list) {
             for (const auto &value: list) {
-                insertBack(value);
+                emplaceBack(value);
             }
         }
 
-        DLList(std::initializer_list<T> list) {
-            for (const auto &value: list) {
-                insertBack(std::make_shared<T>(value));
+        // copies every value, the two lists share nothing
+        DLList(const DLList &rhs) : DLList() {
+            for (const auto &value: rhs) {
+                emplaceBack(value);
+            }
+        }
+
+        DLList(DLList &&rhs) noexcept : m_Head{std::exchange(rhs.m_Head, nullptr)},
+                                        m_Tail{std::exchange(rhs.m_Tail, nullptr)},
+                                        m_Size{std::exchange(rhs.m_Size, 0)} {}
+
+        DLList &operator=(const DLList &rhs) {
+            if (this != &rhs) {
+                DLList copy(rhs);
+                *this = std::move(copy);
             }
+            return *this;
+        }
+
+        DLList &operator=(DLList &&rhs) noexcept {
+            if (this != &rhs) {
+                clear();
+                m_Head = std::exchange(rhs.m_Head, nullptr);
+                m_Tail = std::exchange(rhs.m_Tail, nullptr);
+                m_Size = std::exchange(rhs.m_Size, 0);
+            }
+            return *this;
         }
 
         Stream<T> stream() {
@@ -384,21 +445,111 @@ namespace WayLib {
             return list;
         }
 
+        // Stable bottom-up merge sort that only relinks nodes: nothing is allocated and no value is copied or moved.
+        // Sorted runs of 2^i nodes wait in a fixed array of bins, the same scheme as std::list::sort.
         decltype(auto) sortWith(this auto &&self, auto &&comparator) {
-            std::vector<std::shared_ptr<T> > vec;
-            for (auto it = self.begin(); it != self.end(); ++it) {
-                vec.push_back(it.getNode()->getPtr());
+            Link *bins[64]{};
+            size_t used = 0;
+            for (Link *link = self.m_Head; link;) {
+                Link *next = link->m_Next;
+                link->m_Next = nullptr;
+                Link *carry = link;
+                size_t i = 0;
+                // bins hold earlier elements than carry, so they go first to keep the sort stable
+                for (; i < used && bins[i]; ++i) {
+                    carry = MergeChains(bins[i], carry, comparator);
+                    bins[i] = nullptr;
+                }
+                bins[i] = carry;
+                used = std::max(used, i + 1);
+                link = next;
+            }
+            Link *sorted = nullptr;
+            for (size_t i = 0; i < used; ++i) {
+                if (bins[i]) {
+                    sorted = sorted ? MergeChains(bins[i], sorted, comparator) : bins[i];
+                }
             }
-            std::sort(vec.begin(), vec.end(), [&](const auto &lhs, const auto &rhs) {
-                return comparator(*lhs, *rhs);
-            });
-            self.clear();
-            for (auto &&el: vec) {
-                self.insertBack(std::move(el));
+            self.m_Head = sorted;
+            self.relinkBackward();
+            return std::forward<decltype(self)>(self);
+        }
+
+        ~DLList() {
+            clear();
+        }
+
+    private:
+        template<typename... Args>
+        static Link *MakeLink(Args &&... args) {
+            void *memory = Pool::Allocate();
+            try {
+                return ::new(memory) Link(std::forward<Args>(args)...);
+            } catch (...) {
+                Pool::Deallocate(memory);
+                throw;
+            }
+        }
+
+        static void FreeLink(Link *link) {
+            link->~Link();
+            Pool::Deallocate(link);
+        }
+
+        // links link in front of next, at the back when next is null
+        Link *linkBefore(Link *next, Link *link) {
+            link->m_Next = next;
+            link->m_Prev = next ? next->m_Prev : m_Tail;
+            (link->m_Prev ? link->m_Prev->m_Next : m_Head) = link;
+            (next ? next->m_Prev : m_Tail) = link;
+            ++m_Size;
+            return link;
+        }
+
+        void unlink(Link *link) {
+            (link->m_Prev ? link->m_Prev->m_Next : m_Head) = link->m_Next;
+            (link->m_Next ? link->m_Next->m_Prev : m_Tail) = link->m_Prev;
+            --m_Size;
+        }
+
+        // merges two null terminated chains linked through m_Next only, taking from first on ties
+        static Link *MergeChains(Link *first, Link *second, auto &&comparator) {
+            Link *result = nullptr;
+            Link **out = &result;
+            while (first && second) {
+                if (comparator(second->m_Value, first->m_Value)) {
+                    *out = second;
+                    second = second->m_Next;
+                } else {
+                    *out = first;
+                    first = first->m_Next;
+                }
+                out = &(*out)->m_Next;
+            }
+            *out = first ? first : second;
+            return result;
+        }
+
+        // restores m_Prev and m_Tail after the chain from m_Head was relinked through m_Next
+        void relinkBackward() {
+            Link *prev = nullptr;
+            for (Link *link = m_Head; link; link = link->m_Next) {
+                link->m_Prev = prev;
+                prev = link;
             }
+            m_Tail = prev;
+        }
+
+        static Node MakeNode(Link *link, DLList *list) {
+            return {link, list};
         }
 
-        ~DLList() = default;
+        T take(Link *link) {
+            unlink(link);
+            T value(std::move(link->m_Value));
+            FreeLink(link);
+            return value;
+        }
     };
 
 
@@ -417,6 +568,18 @@ namespace WayLib {
     template<typename T>
     inline void ReadBufferImpl(DataBuffer &buffer, DLList<T> &list) {
         auto size = buffer.read<decltype(list.size())>();
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                // nodes are not contiguous, but the whole payload is still bounds checked once
+                const uint8_t *data = buffer.consume(Impl::ArrayBytes(size, sizeof(T)));
+                for (size_t i = 0; i < size; ++i, data += sizeof(T)) {
+                    T value;
+                    std::memcpy(&value, data, sizeof(T));
+                    list.emplaceBack(value);
+                }
+                return;
+            }
+        }
         for (size_t i = 0; i < size; ++i) {
             list.emplaceBack(buffer.read<T>());
         }
@@ -425,6 +588,16 @@ namespace WayLib {
     template<typename T>
     inline void WriteBufferImpl(DataBuffer &buffer, const DLList<T> &list) {
         buffer.write(list.size());
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                uint8_t *data = buffer.allocate(list.size() * sizeof(T));
+                for (auto &&el: list) {
+                    std::memcpy(data, &el, sizeof(T));
+                    data += sizeof(T);
+                }
+                return;
+            }
+        }
         for (auto &&el: list) {
             buffer.write<T>(el);
         }
@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Util/ThreadLocalCache.hpp"
+
+namespace WayLib::Impl {
+    // Epoch based reclamation for lock-free containers. A thread reads shared nodes only inside a Guard; a node that
+    // has been unlinked is handed to Retire and freed once every thread that was inside a Guard at that time has
+    // left it, so a concurrent reader never touches freed memory. Guards nest and cost two stores and a fence.
+    class EpochReclaimer {
+        struct Record;
+
+    public:
+        class Guard {
+            // only set when the thread's own state is already gone, the guard then announces through its own record
+            Record *m_Record;
+
+        public:
+            Guard() : m_Record{Enter()} {}
+
+            Guard(const Guard &) = delete;
+
+            Guard &operator=(const Guard &) = delete;
+
+            ~Guard() {
+                Exit(m_Record);
+            }
+        };
+
+        // deleter(object) runs on some thread once no Guard that could still see object is active
+        static void Retire(void *object, void (*deleter)(void *)) {
+            auto &global = LeakedSingleton<Global>();
+            Retired retired{object, deleter, global.m_Epoch.load(std::memory_order_seq_cst)};
+            if (!LocalState::Alive()) {
+                std::scoped_lock lock(global.m_OrphanMutex);
+                global.m_Orphans.push_back(retired);
+                return;
+            }
+            auto &local = LocalState::Get();
+            local.m_Limbo.push_back(retired);
+            if (++local.m_SinceCollect >= CollectInterval) {
+                local.m_SinceCollect = 0;
+                TryAdvance();
+                local.collect();
+            }
+        }
+
+    private:
+        static constexpr uint64_t Inactive = UINT64_MAX;
+        static constexpr size_t CollectInterval = 64;
+
+        struct Record {
+            std::atomic<uint64_t> m_Epoch{Inactive};
+            std::atomic<bool> m_InUse{true};
+            Record *m_Next{};
+        };
+
+        struct Retired {
+            void *m_Object;
+            void (*m_Deleter)(void *);
+            uint64_t m_Epoch;
+        };
+
+        struct Global {
+            std::atomic<uint64_t> m_Epoch{0};
+            // records are never freed, a thread that exits leaves its record for the next one
+            std::atomic<Record *> m_Records{};
+            std::mutex m_OrphanMutex;
+            // retired by threads that have exited since
+            std::vector<Retired> m_Orphans;
+        };
+
+        // safe to free: retired two epochs ago, every guard active back then has ended
+        static bool Expired(const Retired &retired, uint64_t epoch) {
+            return retired.m_Epoch + 2 <= epoch;
+        }
+
+        static void FreeExpired(std::vector<Retired> &retired, uint64_t epoch) {
+            auto kept = retired.begin();
+            for (auto &item: retired) {
+                if (Expired(item, epoch)) {
+                    item.m_Deleter(item.m_Object);
+                } else {
+                    *kept++ = item;
+                }
+            }
+            retired.erase(kept, retired.end());
+        }
+
+        // the thread's record, guard depth and retired objects; at thread exit the record goes back for reuse and
+        // whatever is still retired becomes an orphan for other threads to free
+        struct Local {
+            Record *m_Record{};
+            size_t m_Depth{};
+            size_t m_SinceCollect{};
+            std::vector<Retired> m_Limbo;
+
+            void collect() {
+                auto &global = LeakedSingleton<Global>();
+                uint64_t epoch = global.m_Epoch.load(std::memory_order_seq_cst);
+                FreeExpired(m_Limbo, epoch);
+                if (std::unique_lock lock(global.m_OrphanMutex, std::try_to_lock); lock && !global.m_Orphans.empty()) {
+                    FreeExpired(global.m_Orphans, epoch);
+                }
+            }
+
+            ~Local() {
+                if (m_Record) {
+                    ReleaseRecord(m_Record);
+                }
+                auto &global = LeakedSingleton<Global>();
+                std::scoped_lock lock(global.m_OrphanMutex);
+                global.m_Orphans.insert(global.m_Orphans.end(), m_Limbo.begin(), m_Limbo.end());
+            }
+        };
+
+        using LocalState = ThreadLocalCache<Local>;
+
+        static Record *AcquireRecord() {
+            auto &global = LeakedSingleton<Global>();
+            for (Record *record = global.m_Records.load(std::memory_order_acquire); record; record = record->m_Next) {
+                bool inUse = false;
+                if (record->m_InUse.compare_exchange_strong(inUse, true, std::memory_order_acq_rel)) {
+                    return record;
+                }
+            }
+            auto *record = new Record;
+            Record *head = global.m_Records.load(std::memory_order_relaxed);
+            do {
+                record->m_Next = head;
+            } while (!global.m_Records.compare_exchange_weak(head, record, std::memory_order_release,
+                                                             std::memory_order_relaxed));
+            return record;
+        }
+
+        static void ReleaseRecord(Record *record) {
+            record->m_InUse.store(false, std::memory_order_release);
+        }
+
+        // moves the global epoch on if every thread inside a guard has seen the current one
+        static void TryAdvance() {
+            auto &global = LeakedSingleton<Global>();
+            uint64_t epoch = global.m_Epoch.load(std::memory_order_seq_cst);
+            for (Record *record = global.m_Records.load(std::memory_order_acquire); record; record = record->m_Next) {
+                uint64_t seen = record->m_Epoch.load(std::memory_order_seq_cst);
+                if (seen != Inactive && seen != epoch) {
+                    return;
+                }
+            }
+            global.m_Epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        }
+
+        static void Announce(Record &record) {
+            record.m_Epoch.store(LeakedSingleton<Global>().m_Epoch.load(std::memory_order_seq_cst),
+                                 std::memory_order_seq_cst);
+            // the announcement has to be visible before any shared pointer is read
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        // returns the record the guard owns, null when it uses the thread's
+        static Record *Enter() {
+            if (!LocalState::Alive()) {
+                Record *record = AcquireRecord();
+                Announce(*record);
+                return record;
+            }
+            auto &local = LocalState::Get();
+            if (local.m_Depth++ == 0) {
+                if (!local.m_Record) {
+                    local.m_Record = AcquireRecord();
+                }
+                Announce(*local.m_Record);
+            }
+            return nullptr;
+        }
+
+        static void Exit(Record *owned) {
+            if (owned) {
+                owned->m_Epoch.store(Inactive, std::memory_order_release);
+                ReleaseRecord(owned);
+                return;
+            }
+            auto &local = LocalState::Get();
+            if (--local.m_Depth == 0) {
+                local.m_Record->m_Epoch.store(Inactive, std::memory_order_release);
+            }
+        }
+    };
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "Util/ThreadLocalCache.hpp"
+
+namespace WayLib::Impl {
+    // Fixed size blocks for linked container nodes, carved out of 64 KiB slabs. Every thread keeps its own free list,
+    // so once warm a node costs a couple of pointer moves, no lock and no trip to the allocator. A node may be freed
+    // on any thread, it then joins that thread's list. Slabs are never handed back to the system, they stay (in an
+    // intentionally leaked registry) for later nodes of the same size.
+    template<size_t Size, size_t Align>
+    class NodePool {
+        struct FreeBlock {
+            FreeBlock *m_Next;
+        };
+
+    public:
+        static constexpr size_t BlockAlign = std::max(Align, alignof(FreeBlock));
+        static constexpr size_t BlockSize = (std::max(Size, sizeof(FreeBlock)) + BlockAlign - 1) / BlockAlign * BlockAlign;
+        static constexpr size_t SlabSize = 64 * 1024;
+        static constexpr size_t BlocksPerSlab = std::max<size_t>(SlabSize / BlockSize, 1);
+        // a thread keeps at most this many free blocks, half of them go to the shared list beyond that
+        static constexpr size_t MaxCachedBlocks = 4 * BlocksPerSlab;
+
+        static void *Allocate() {
+            if (!LocalCache::Alive()) {
+                return AllocateShared();
+            }
+            auto &cache = LocalCache::Get();
+            if (!cache.m_Free) {
+                cache.refill();
+            }
+            FreeBlock *block = cache.m_Free;
+            cache.m_Free = block->m_Next;
+            --cache.m_Count;
+            return block;
+        }
+
+        static void Deallocate(void *pointer) {
+            auto *block = ::new(pointer) FreeBlock{};
+            if (!LocalCache::Alive()) {
+                DeallocateShared(block);
+                return;
+            }
+            auto &cache = LocalCache::Get();
+            block->m_Next = cache.m_Free;
+            cache.m_Free = block;
+            if (++cache.m_Count > MaxCachedBlocks) {
+                cache.spill(MaxCachedBlocks / 2);
+            }
+        }
+
+    private:
+        struct Shared {
+            std::mutex m_Mutex;
+            std::vector<std::byte *> m_Slabs;
+            FreeBlock *m_Free{};
+        };
+
+        struct Cache {
+            FreeBlock *m_Free{};
+            size_t m_Count{};
+
+            // takes up to a slab's worth of blocks from the shared list, or a whole new slab
+            void refill() {
+                auto &shared = LeakedSingleton<Shared>();
+                std::scoped_lock lock(shared.m_Mutex);
+                if (!shared.m_Free) {
+                    m_Free = NewSlab(shared);
+                    m_Count = BlocksPerSlab;
+                    return;
+                }
+                while (shared.m_Free && m_Count < BlocksPerSlab) {
+                    FreeBlock *block = shared.m_Free;
+                    shared.m_Free = block->m_Next;
+                    block->m_Next = m_Free;
+                    m_Free = block;
+                    ++m_Count;
+                }
+            }
+
+            // moves count blocks to the shared list
+            void spill(size_t count) {
+                if (!count) {
+                    return;
+                }
+                FreeBlock *first = m_Free;
+                FreeBlock *last = first;
+                for (size_t i = 1; i < count; ++i) {
+                    last = last->m_Next;
+                }
+                m_Free = last->m_Next;
+                m_Count -= count;
+
+                auto &shared = LeakedSingleton<Shared>();
+                std::scoped_lock lock(shared.m_Mutex);
+                last->m_Next = shared.m_Free;
+                shared.m_Free = first;
+            }
+
+            ~Cache() {
+                spill(m_Count);
+            }
+        };
+
+        using LocalCache = ThreadLocalCache<Cache>;
+
+        // a new slab as a list of free blocks, the caller holds the shared mutex
+        static FreeBlock *NewSlab(Shared &shared) {
+            auto *slab = static_cast<std::byte *>(::operator new(BlocksPerSlab * BlockSize, std::align_val_t{BlockAlign}));
+            shared.m_Slabs.push_back(slab);
+            FreeBlock *head = nullptr;
+            for (size_t i = BlocksPerSlab; i-- > 0;) {
+                head = ::new(slab + i * BlockSize) FreeBlock{head};
+            }
+            return head;
+        }
+
+        static void *AllocateShared() {
+            auto &shared = LeakedSingleton<Shared>();
+            std::scoped_lock lock(shared.m_Mutex);
+            if (!shared.m_Free) {
+                shared.m_Free = NewSlab(shared);
+            }
+            FreeBlock *block = shared.m_Free;
+            shared.m_Free = block->m_Next;
+            return block;
+        }
+
+        static void DeallocateShared(FreeBlock *block) {
+            auto &shared = LeakedSingleton<Shared>();
+            std::scoped_lock lock(shared.m_Mutex);
+            block->m_Next = shared.m_Free;
+            shared.m_Free = block;
+        }
+    };
+}
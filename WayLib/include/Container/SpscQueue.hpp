@@ -0,0 +1,272 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include "Container/WaitStrategy.hpp"
+
+namespace WayLib {
+    // Bounded queue for exactly one producer thread and one consumer thread, with emplace / push / tryPull / pull /
+    // tryVisit / visit plus pushBulk / pullBulk. There is no close() as on ThreadSafeQueue, so pull returns the value
+    // itself and waits as long as it takes. Each side owns one index and keeps a cached copy of the other side's, so a
+    // push or pull is a plain store with no read-modify-write, and it only touches the other side's cache line when the
+    // cached index says the ring looks full (or empty). Bulk operations publish a whole batch with one store and one
+    // notify. Waiting on a full or empty ring is up to WaitStrategy, as with BoundedQueue.
+    template<typename T, typename WaitStrategy = HybridWait>
+    class SpscQueue {
+        struct Slot {
+            alignas(T) std::byte m_Storage[sizeof(T)];
+
+            T *value() {
+                return std::launder(reinterpret_cast<T *>(m_Storage));
+            }
+        };
+
+        size_t m_Mask;
+        std::unique_ptr<Slot[]> m_Slots;
+
+        // written by the producer only
+        alignas(64) std::atomic<size_t> m_Tail{};
+        size_t m_CachedHead{};
+
+        // written by the consumer only
+        alignas(64) std::atomic<size_t> m_Head{};
+        size_t m_CachedTail{};
+
+        alignas(64) WaitStrategy m_NotEmpty;
+        alignas(64) WaitStrategy m_NotFull;
+
+    public:
+        using value_type = T;
+
+        // the capacity is rounded up to a power of two
+        explicit SpscQueue(size_t capacity) : m_Mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1},
+                                              m_Slots{std::make_unique<Slot[]>(m_Mask + 1)} {}
+
+        SpscQueue(const SpscQueue &) = delete;
+
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        // no other thread may still be using the queue
+        ~SpscQueue() {
+            for (size_t head = m_Head.load(std::memory_order_relaxed); head != m_Tail.load(std::memory_order_relaxed);
+                 ++head) {
+                std::destroy_at(m_Slots[head & m_Mask].value());
+            }
+        }
+
+        // producer side
+
+        bool tryEmplace(auto &&... args) {
+            size_t tail = m_Tail.load(std::memory_order_relaxed);
+            if (!writableCount(tail, 1)) {
+                return false;
+            }
+            ::new(m_Slots[tail & m_Mask].m_Storage) T(std::forward<decltype(args)>(args)...);
+            publishTail(tail + 1);
+            return true;
+        }
+
+        bool tryPush(T &&data) {
+            return tryEmplace(std::move(data));
+        }
+
+        bool tryPush(const T &data) {
+            return tryEmplace(data);
+        }
+
+        // waits while the queue is full
+        void emplace(auto &&... args) {
+            size_t tail = m_Tail.load(std::memory_order_relaxed);
+            while (!writableCount(tail, 1)) {
+                m_NotFull.wait([this] { return writable(); });
+            }
+            ::new(m_Slots[tail & m_Mask].m_Storage) T(std::forward<decltype(args)>(args)...);
+            publishTail(tail + 1);
+        }
+
+        void push(T &&data) {
+            this->emplace(std::move(data));
+        }
+
+        void push(const T &data) {
+            this->emplace(data);
+        }
+
+        // copies up to count elements from first, as many as fit; returns how many went in
+        // (pass a std::move_iterator to move them)
+        size_t tryPushBulk(std::input_iterator auto first, size_t count) {
+            std::counted_iterator it(std::move(first), static_cast<std::iter_difference_t<decltype(first)>>(count));
+            return pushSome(it, std::default_sentinel);
+        }
+
+        // copies all of [first, last), waiting for room whenever the ring is full
+        void pushBulk(std::input_iterator auto first, auto last) {
+            while (first != last) {
+                if (!pushSome(first, last)) {
+                    m_NotFull.wait([this] { return writable(); });
+                }
+            }
+        }
+
+        // consumer side
+
+        std::optional<T> tryPull() {
+            std::optional<T> result;
+            size_t head = m_Head.load(std::memory_order_relaxed);
+            if (readableCount(head, 1)) {
+                result.emplace(take(head));
+                publishHead(head + 1);
+            }
+            return result;
+        }
+
+        // waits while the queue is empty
+        T pull() {
+            size_t head = m_Head.load(std::memory_order_relaxed);
+            while (!readableCount(head, 1)) {
+                m_NotEmpty.wait([this] { return readable(); });
+            }
+            T result = take(head);
+            publishHead(head + 1);
+            return result;
+        }
+
+        bool tryVisit(auto &&visitor) {
+            auto result = tryPull();
+            if (!result) {
+                return false;
+            }
+            std::invoke(visitor, std::move(*result));
+            return true;
+        }
+
+        void visit(auto &&visitor) {
+            std::invoke(visitor, pull());
+        }
+
+        // moves up to maxCount elements to out, returns how many
+        size_t tryPullBulk(auto out, size_t maxCount) {
+            return pullSome(out, maxCount);
+        }
+
+        // waits for at least one element, then moves up to maxCount to out and returns how many
+        size_t pullBulk(auto out, size_t maxCount) {
+            if (!maxCount) {
+                return 0;
+            }
+            size_t pulled;
+            while (!(pulled = pullSome(out, maxCount))) {
+                m_NotEmpty.wait([this] { return readable(); });
+            }
+            return pulled;
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return m_Mask + 1;
+        }
+
+        // a snapshot, exact only on the producer or the consumer thread
+        [[nodiscard]] size_t size() const {
+            size_t head = m_Head.load(std::memory_order_acquire);
+            return m_Tail.load(std::memory_order_acquire) - head;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return !readable();
+        }
+
+    private:
+        // free slots from tail on, looks at the consumer's index only when the cached one leaves fewer than wanted
+        size_t writableCount(size_t tail, size_t wanted) {
+            size_t free = capacity() - (tail - m_CachedHead);
+            if (free < wanted) {
+                m_CachedHead = m_Head.load(std::memory_order_acquire);
+                free = capacity() - (tail - m_CachedHead);
+            }
+            return free;
+        }
+
+        // filled slots from head on, looks at the producer's index only when the cached one shows fewer than wanted
+        size_t readableCount(size_t head, size_t wanted) {
+            size_t filled = m_CachedTail - head;
+            if (filled < wanted) {
+                m_CachedTail = m_Tail.load(std::memory_order_acquire);
+                filled = m_CachedTail - head;
+            }
+            return filled;
+        }
+
+        bool writable() const {
+            return m_Tail.load(std::memory_order_relaxed) - m_Head.load(std::memory_order_acquire) <= m_Mask;
+        }
+
+        bool readable() const {
+            return m_Tail.load(std::memory_order_acquire) != m_Head.load(std::memory_order_relaxed);
+        }
+
+        void publishTail(size_t tail) {
+            m_Tail.store(tail, std::memory_order_release);
+            m_NotEmpty.notify();
+        }
+
+        void publishHead(size_t head) {
+            m_Head.store(head, std::memory_order_release);
+            m_NotFull.notify();
+        }
+
+        // constructs from first until last or the ring is full, then publishes them all at once
+        size_t pushSome(auto &first, const auto &last) {
+            size_t tail = m_Tail.load(std::memory_order_relaxed);
+            size_t room = writableCount(tail, capacity());
+            size_t pushed = 0;
+            try {
+                for (; pushed < room && first != last; ++pushed, ++first) {
+                    ::new(m_Slots[(tail + pushed) & m_Mask].m_Storage) T(*first);
+                }
+            } catch (...) {
+                // the elements constructed so far still go in
+                if (pushed) {
+                    publishTail(tail + pushed);
+                }
+                throw;
+            }
+            if (pushed) {
+                publishTail(tail + pushed);
+            }
+            return pushed;
+        }
+
+        size_t pullSome(auto &out, size_t maxCount) {
+            size_t head = m_Head.load(std::memory_order_relaxed);
+            size_t count = std::min(readableCount(head, maxCount), maxCount);
+            for (size_t i = 0; i < count; ++i) {
+                try {
+                    *out = take(head + i);
+                } catch (...) {
+                    // the slot was already emptied, give it and the ones before back to the producer
+                    publishHead(head + i + 1);
+                    throw;
+                }
+                ++out;
+            }
+            if (count) {
+                publishHead(head + count);
+            }
+            return count;
+        }
+
+        T take(size_t position) {
+            T *value = m_Slots[position & m_Mask].value();
+            T result(std::move(*value));
+            std::destroy_at(value);
+            return result;
+        }
+    };
+}
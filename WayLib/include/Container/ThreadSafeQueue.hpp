@@ -2,7 +2,15 @@
 
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
 
 template<typename T, template<typename> typename Container = std::queue>
 class ThreadSafeQueue {
@@ -15,16 +23,55 @@ public:
 
     // ThreadSafeQueue is non-copyable, non-movable, if you want to move it, you can use std::unique_ptr<ThreadSafeQueue<T>>
 
-    void emplace(auto &&... args) { {
+    // Producers only notify when some thread is actually waiting (in pull / visit / wait), so pushing to busy
+    // consumers never reaches the kernel; once getCondition() has been handed out every push notifies again.
+    // Pushes after close() are dropped and return false.
+
+    bool emplace(auto &&... args) {
+        bool wake; {
             std::scoped_lock lock(m_Mutex);
+            if (m_Closed) {
+                return false;
+            }
             m_Data.emplace(std::forward<decltype(args)>(args)...);
+            wake = shouldNotify();
         }
 
-        m_Condition.notify_one();
+        if (wake) {
+            m_Condition.notify_one();
+        }
+        return true;
+    }
+
+    bool push(T &&data) {
+        return this->emplace(std::move(data));
     }
 
-    void push(T &&data) {
-        this->emplace(std::move(data));
+    // pushes every element of range under one lock, then wakes the waiters once
+    bool pushBatch(auto &&range) {
+        size_t count = 0;
+        bool wake; {
+            std::scoped_lock lock(m_Mutex);
+            if (m_Closed) {
+                return false;
+            }
+            for (auto &&element: range) {
+                if constexpr (std::is_rvalue_reference_v<decltype(range)>) {
+                    m_Data.emplace(std::move(element));
+                } else {
+                    m_Data.emplace(element);
+                }
+                ++count;
+            }
+            wake = shouldNotify();
+        }
+
+        if (wake && count == 1) {
+            m_Condition.notify_one();
+        } else if (wake && count > 1) {
+            m_Condition.notify_all();
+        }
+        return true;
     }
 
     std::optional<T> tryPull() {
@@ -39,14 +86,64 @@ public:
         return result;
     }
 
-    T pull() {
+    // waits for an element; empty once the queue is closed and everything pushed before has been pulled
+    std::optional<T> pull() {
         std::unique_lock lock(m_Mutex);
-        m_Condition.wait(lock, [this] { return !m_Data.empty(); });
-        T result = std::move(m_Data.front());
+        if (!await(lock)) {
+            return std::nullopt;
+        }
+        std::optional<T> result = std::move(m_Data.front());
         m_Data.pop();
         return result;
     }
 
+    // waits at most timeout for an element, empty on timeout or when closed and drained
+    template<typename Rep, typename Period>
+    std::optional<T> pullFor(const std::chrono::duration<Rep, Period> &timeout) {
+        std::unique_lock lock(m_Mutex);
+        ++m_Waiters;
+        m_Condition.wait_for(lock, timeout, [this] { return !m_Data.empty() || m_Closed; });
+        --m_Waiters;
+        if (m_Data.empty()) {
+            return std::nullopt;
+        }
+        std::optional<T> result = std::move(m_Data.front());
+        m_Data.pop();
+        return result;
+    }
+
+    // waits for at least one element, then moves up to maxCount to out under the same lock; returns how many,
+    // 0 once closed and drained
+    size_t pullBatch(size_t maxCount, auto out) {
+        if (!maxCount) {
+            return 0;
+        }
+        std::unique_lock lock(m_Mutex);
+        if (!await(lock)) {
+            return 0;
+        }
+        return moveOut(maxCount, out);
+    }
+
+    // moves every queued element to the back of container without waiting, returns how many; a container of the
+    // queue's own type that is still empty is simply swapped in
+    size_t drainTo(auto &container) {
+        std::scoped_lock lock(m_Mutex);
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(container)>, Container<T>>) {
+            if (container.empty()) {
+                std::swap(container, m_Data);
+                return container.size();
+            }
+            size_t count = m_Data.size();
+            for (; !m_Data.empty(); m_Data.pop()) {
+                container.emplace(std::move(m_Data.front()));
+            }
+            return count;
+        } else {
+            return moveOut(m_Data.size(), std::back_inserter(container));
+        }
+    }
+
     bool tryVisit(auto &&visitor) {
         std::unique_lock lock(m_Mutex);
         if (m_Data.empty()) {
@@ -57,11 +154,30 @@ public:
         return true;
     }
 
-    void visit(auto &&visitor) {
+    // false once closed and drained, the visitor is not called then
+    bool visit(auto &&visitor) {
         std::unique_lock lock(m_Mutex);
-        m_Condition.wait(lock, [this] { return !m_Data.empty(); });
+        if (!await(lock)) {
+            return false;
+        }
         std::invoke(visitor, std::move(m_Data.front()));
         m_Data.pop();
+        return true;
+    }
+
+    // Refuses further pushes and wakes every waiter. Elements already queued can still be pulled, after that
+    // pull / visit / pullBatch return empty instead of waiting.
+    void close() { {
+            std::scoped_lock lock(m_Mutex);
+            m_Closed = true;
+        }
+
+        m_Condition.notify_all();
+    }
+
+    bool isClosed() const {
+        std::scoped_lock lock(m_Mutex);
+        return m_Closed;
     }
 
     const Container<T> &getData() const {
@@ -92,12 +208,47 @@ public:
         return m_Mutex;
     }
 
+    // waits on the queue's condition with lock holding getMutex(), counted like a pull so pushes keep notifying
+    void wait(std::unique_lock<std::mutex> &lock, auto &&predicate) const {
+        ++m_Waiters;
+        m_Condition.wait(lock, std::forward<decltype(predicate)>(predicate));
+        --m_Waiters;
+    }
+
+    // waits on it directly cannot be counted, so from now on every push notifies
     std::condition_variable &getCondition() const {
+        m_ConditionShared.store(true, std::memory_order_relaxed);
         return m_Condition;
     }
 
 private:
+    // waits until there is an element or the queue is closed, false when closed and empty
+    bool await(std::unique_lock<std::mutex> &lock) {
+        wait(lock, [this] { return !m_Data.empty() || m_Closed; });
+        return !m_Data.empty();
+    }
+
+    // the lock is held; getCondition() is stored before its caller can take the lock to wait
+    bool shouldNotify() const {
+        return m_Waiters > 0 || m_ConditionShared.load(std::memory_order_relaxed);
+    }
+
+    // the lock is held
+    size_t moveOut(size_t maxCount, auto out) {
+        size_t count = 0;
+        for (; count < maxCount && !m_Data.empty(); ++count) {
+            *out = std::move(m_Data.front());
+            ++out;
+            m_Data.pop();
+        }
+        return count;
+    }
+
     Container<T> m_Data;
     mutable std::mutex m_Mutex;
     mutable std::condition_variable m_Condition;
+    // threads blocked on m_Condition through pull / visit / wait
+    mutable size_t m_Waiters{};
+    mutable std::atomic<bool> m_ConditionShared{};
+    bool m_Closed{};
 };
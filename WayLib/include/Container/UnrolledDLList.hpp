@@ -0,0 +1,611 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Container/NodePool.hpp"
+#include "Util/DataBuffer.hpp"
+#include "Util/Stream.hpp"
+#include "Util/StreamUtil.hpp"
+
+namespace WayLib {
+    // chunk size of an UnrolledDLList, as a type so the list still fits inject_container_traits
+    template<size_t Bytes>
+    using UnrolledChunkBytes = std::integral_constant<size_t, Bytes>;
+
+    // A doubly linked list of chunks, each holding up to Capacity elements (about ChunkBytes::value bytes) side by
+    // side, so a traversal reads contiguous memory and takes one cache miss per chunk instead of one per element.
+    // Chunks come from Impl::NodePool like DLList nodes. Same interface as DLList, with one difference: an insert or
+    // erase moves the other elements of its chunk (and may split or merge chunks), so it invalidates iterators into
+    // that chunk and its neighbours. forEach, filter and fold run chunk by chunk; forEachChunk hands out spans.
+    template<typename T, typename ChunkBytes = UnrolledChunkBytes<1024> >
+    class UnrolledDLList : public inject_container_traits<UnrolledDLList, T> {
+    public:
+        static constexpr size_t Capacity = std::max<size_t>(ChunkBytes::value / sizeof(T), 2);
+
+    private:
+        struct Chunk {
+            Chunk *m_Next{};
+            Chunk *m_Prev{};
+            size_t m_Count{};
+            alignas(T) std::byte m_Storage[Capacity * sizeof(T)];
+
+            T *data() {
+                return std::launder(reinterpret_cast<T *>(m_Storage));
+            }
+        };
+
+        using Pool = Impl::NodePool<sizeof(Chunk), alignof(Chunk)>;
+
+        Chunk *m_Head{};
+        Chunk *m_Tail{};
+
+        size_t m_Size{};
+
+        template<typename U, typename Bytes>
+        friend void ReadBufferImpl(DataBuffer &buffer, UnrolledDLList<U, Bytes> &list);
+
+    public:
+        using value_type = T;
+
+        // Iterator
+        template<bool Const>
+        class BasicIterator {
+            using ListType = std::conditional_t<Const, const UnrolledDLList, UnrolledDLList>;
+
+            Chunk *m_Chunk{};
+            size_t m_Index{};
+            ListType *m_List{};
+
+            friend class UnrolledDLList;
+            friend class BasicIterator<!Const>;
+
+            BasicIterator(Chunk *chunk, size_t index, ListType *list) : m_Chunk{chunk}, m_Index{index}, m_List{list} {}
+
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T *, T *>;
+            using reference = std::conditional_t<Const, const T &, T &>;
+
+            BasicIterator() = default;
+
+            template<bool IsConst = Const> requires IsConst
+            BasicIterator(const BasicIterator<false> &other)
+                : m_Chunk{other.m_Chunk}, m_Index{other.m_Index}, m_List{other.m_List} {}
+
+            explicit operator bool() const {
+                return m_Chunk;
+            }
+
+            reference operator*() const {
+                return m_Chunk->data()[m_Index];
+            }
+
+            pointer operator->() const {
+                return m_Chunk->data() + m_Index;
+            }
+
+            reference getValue() const {
+                return m_Chunk->data()[m_Index];
+            }
+
+            operator reference() const {
+                return m_Chunk->data()[m_Index];
+            }
+
+            bool operator==(const BasicIterator &other) const {
+                return m_Chunk == other.m_Chunk && m_Index == other.m_Index;
+            }
+
+            BasicIterator &operator++() {
+                if (++m_Index == m_Chunk->m_Count) {
+                    m_Chunk = m_Chunk->m_Next;
+                    m_Index = 0;
+                }
+                return *this;
+            }
+
+            BasicIterator operator++(int) {
+                auto copy = *this;
+                ++(*this);
+                return copy;
+            }
+
+            // end() steps back onto the last element
+            BasicIterator &operator--() {
+                if (!m_Chunk) {
+                    m_Chunk = m_List->m_Tail;
+                    m_Index = m_Chunk->m_Count - 1;
+                } else if (m_Index) {
+                    --m_Index;
+                } else {
+                    m_Chunk = m_Chunk->m_Prev;
+                    m_Index = m_Chunk->m_Count - 1;
+                }
+                return *this;
+            }
+
+            BasicIterator operator--(int) {
+                auto copy = *this;
+                --(*this);
+                return copy;
+            }
+
+            // node operations, as on DLList::Node
+
+            BasicIterator getNext() const {
+                return std::next(*this);
+            }
+
+            BasicIterator getPrev() const {
+                return m_Chunk->m_Prev || m_Index ? std::prev(*this) : BasicIterator{nullptr, 0, m_List};
+            }
+
+            BasicIterator insertAfter(auto &&value) const requires (!Const) {
+                return emplaceAfter(std::forward<decltype(value)>(value));
+            }
+
+            BasicIterator insertBefore(auto &&value) const requires (!Const) {
+                return emplaceBefore(std::forward<decltype(value)>(value));
+            }
+
+            BasicIterator emplaceAfter(auto &&... args) const requires (!Const) {
+                return m_List->emplaceAt(m_Chunk, m_Index + 1, std::forward<decltype(args)>(args)...);
+            }
+
+            BasicIterator emplaceBefore(auto &&... args) const requires (!Const) {
+                return m_List->emplaceAt(m_Chunk, m_Index, std::forward<decltype(args)>(args)...);
+            }
+
+            // removes the element and returns it, the iterator must not be used afterwards
+            T pop() const requires (!Const) {
+                T value(std::move(m_Chunk->data()[m_Index]));
+                m_List->eraseAt(m_Chunk, m_Index);
+                return value;
+            }
+        };
+
+        using Iterator = BasicIterator<false>;
+        using ConstIterator = BasicIterator<true>;
+        using Node = Iterator;
+
+        Node getHead() {
+            return begin();
+        }
+
+        Node getTail() {
+            return m_Tail ? Node{m_Tail, m_Tail->m_Count - 1, this} : end();
+        }
+
+        // primitive operations for CRTP
+        [[nodiscard]] size_t size() const {
+            return m_Size;
+        }
+
+        // begin, end, erase
+        decltype(auto) push(this auto &&self, auto &&item) {
+            self.emplaceBack(std::forward<decltype(item)>(item));
+            return std::forward<decltype(self)>(self);
+        }
+
+        decltype(auto) emplace(this auto &&self, auto &&... args) {
+            self.emplaceBack(std::forward<decltype(args)>(args)...);
+            return std::forward<decltype(self)>(self);
+        }
+
+        decltype(auto) resize(this auto &&self, size_t n) {
+            while (self.size() > n) {
+                self.popBack();
+            }
+        }
+
+        decltype(auto) setData(this auto &&self, UnrolledDLList &&data) {
+            self = std::move(data);
+        }
+
+        Node insertFront(auto &&value) {
+            return emplaceFront(std::forward<decltype(value)>(value));
+        }
+
+        Node insertBack(auto &&value) {
+            return emplaceBack(std::forward<decltype(value)>(value));
+        }
+
+        Node emplaceFront(auto &&... args) {
+            return emplaceAt(m_Head, 0, std::forward<decltype(args)>(args)...);
+        }
+
+        Node emplaceBack(auto &&... args) {
+            return emplaceAt(m_Tail, m_Tail ? m_Tail->m_Count : 0, std::forward<decltype(args)>(args)...);
+        }
+
+        std::optional<T> popFront() {
+            if (m_Head) {
+                return getHead().pop();
+            }
+            return std::nullopt;
+        }
+
+        std::optional<T> popBack() {
+            if (m_Tail) {
+                return getTail().pop();
+            }
+            return std::nullopt;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return !m_Size;
+        }
+
+        Iterator begin() {
+            return {m_Head, 0, this};
+        }
+
+        Iterator end() {
+            return {nullptr, 0, this};
+        }
+
+        ConstIterator begin() const {
+            return {m_Head, 0, this};
+        }
+
+        ConstIterator end() const {
+            return {nullptr, 0, this};
+        }
+
+        auto rbegin() {
+            return std::reverse_iterator<Iterator>(end());
+        }
+
+        auto rend() {
+            return std::reverse_iterator<Iterator>(begin());
+        }
+
+        auto rbegin() const {
+            return std::reverse_iterator<ConstIterator>(end());
+        }
+
+        auto rend() const {
+            return std::reverse_iterator<ConstIterator>(begin());
+        }
+
+        // returns the iterator to the element after the erased one
+        Iterator erase(const Iterator &it) {
+            return eraseAt(it.m_Chunk, it.m_Index);
+        }
+
+        Iterator erase(const Iterator &begin, const Iterator &end) {
+            // end moves as elements shift, count first
+            auto count = std::distance(begin, end);
+            auto it = begin;
+            while (count-- > 0) {
+                it = erase(it);
+            }
+            return it;
+        }
+
+        void clear() {
+            for (Chunk *chunk = m_Head; chunk;) {
+                Chunk *next = chunk->m_Next;
+                std::destroy_n(chunk->data(), chunk->m_Count);
+                FreeChunk(chunk);
+                chunk = next;
+            }
+            m_Head = m_Tail = nullptr;
+            m_Size = 0;
+        }
+
+        // action(std::span<T>) once per chunk, in order, std::span<const T> on a const list
+        decltype(auto) forEachChunk(this auto &&self, auto &&action) {
+            using Element = std::remove_reference_t<decltype(*self.begin())>;
+            for (Chunk *chunk = self.m_Head; chunk; chunk = chunk->m_Next) {
+                action(std::span<Element>(chunk->data(), chunk->m_Count));
+            }
+            return std::forward<decltype(self)>(self);
+        }
+
+        decltype(auto) forEach(this auto &&self, auto &&action) {
+            for (Chunk *chunk = self.m_Head; chunk; chunk = chunk->m_Next) {
+                T *data = chunk->data();
+                for (size_t i = 0, count = chunk->m_Count; i < count; ++i) {
+                    action(self.forward(data[i]));
+                }
+            }
+            return std::forward<decltype(self)>(self);
+        }
+
+        // keeps the elements filter accepts, compacting them forward in place; emptied chunks are freed
+        decltype(auto) filter(this auto &&self, auto &&predicate) {
+            Chunk *target = self.m_Head;
+            size_t targetIndex = 0;
+            size_t kept = 0;
+            for (Chunk *chunk = self.m_Head; chunk; chunk = chunk->m_Next) {
+                for (size_t i = 0; i < chunk->m_Count; ++i) {
+                    T &item = chunk->data()[i];
+                    if (!predicate(item)) {
+                        continue;
+                    }
+                    if (&target->data()[targetIndex] != &item) {
+                        target->data()[targetIndex] = std::move(item);
+                    }
+                    ++kept;
+                    if (++targetIndex == target->m_Count) {
+                        target = target->m_Next;
+                        targetIndex = 0;
+                    }
+                }
+            }
+            if (target) {
+                std::destroy(target->data() + targetIndex, target->data() + target->m_Count);
+                target->m_Count = targetIndex;
+                Chunk *last = targetIndex ? target : target->m_Prev;
+                for (Chunk *chunk = targetIndex ? target->m_Next : target; chunk;) {
+                    Chunk *next = chunk->m_Next;
+                    std::destroy_n(chunk->data(), chunk->m_Count);
+                    FreeChunk(chunk);
+                    chunk = next;
+                }
+                (last ? last->m_Next : self.m_Head) = nullptr;
+                self.m_Tail = last;
+            }
+            self.m_Size = kept;
+            return std::forward<decltype(self)>(self);
+        }
+
+        UnrolledDLList() = default;
+
+        UnrolledDLList(std::initializer_list<T> list) {
+            for (const auto &value: list) {
+                emplaceBack(value);
+            }
+        }
+
+        UnrolledDLList(const UnrolledDLList &rhs) : UnrolledDLList() {
+            for (const auto &value: rhs) {
+                emplaceBack(value);
+            }
+        }
+
+        UnrolledDLList(UnrolledDLList &&rhs) noexcept : m_Head{std::exchange(rhs.m_Head, nullptr)},
+                                                        m_Tail{std::exchange(rhs.m_Tail, nullptr)},
+                                                        m_Size{std::exchange(rhs.m_Size, 0)} {}
+
+        UnrolledDLList &operator=(const UnrolledDLList &rhs) {
+            if (this != &rhs) {
+                UnrolledDLList copy(rhs);
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        UnrolledDLList &operator=(UnrolledDLList &&rhs) noexcept {
+            if (this != &rhs) {
+                clear();
+                m_Head = std::exchange(rhs.m_Head, nullptr);
+                m_Tail = std::exchange(rhs.m_Tail, nullptr);
+                m_Size = std::exchange(rhs.m_Size, 0);
+            }
+            return *this;
+        }
+
+        Stream<T> stream() {
+            Stream<T> stream;
+            stream.getData().reserve(m_Size);
+            for (auto &&el: *this) {
+                stream.getData().push_back(std::move(el));
+            }
+            return stream;
+        }
+
+        static auto Of(auto &&container) {
+            UnrolledDLList<std::remove_reference_t<decltype(*container.begin())> > list;
+
+            std::for_each(container.begin(), container.end(), [&](auto &&el) {
+                list.emplaceBack(std::move(el));
+            });
+
+            return list;
+        }
+
+        static auto Of(const auto &container) {
+            UnrolledDLList<std::remove_reference_t<decltype(*container.begin())> > list;
+
+            std::for_each(container.begin(), container.end(), [&](const auto &el) {
+                list.emplaceBack(el);
+            });
+
+            return list;
+        }
+
+        // sorts the values out of line and moves them back into the same slots, the chunks stay as they are
+        decltype(auto) sortWith(this auto &&self, auto &&comparator) {
+            std::vector<T> values;
+            values.reserve(self.m_Size);
+            for (auto &&el: self) {
+                values.push_back(std::move(el));
+            }
+            std::stable_sort(values.begin(), values.end(), comparator);
+            auto it = values.begin();
+            for (auto &&el: self) {
+                el = std::move(*it++);
+            }
+            return std::forward<decltype(self)>(self);
+        }
+
+        ~UnrolledDLList() {
+            clear();
+        }
+
+    private:
+        static Chunk *NewChunk() {
+            return ::new(Pool::Allocate()) Chunk;
+        }
+
+        static void FreeChunk(Chunk *chunk) {
+            chunk->~Chunk();
+            Pool::Deallocate(chunk);
+        }
+
+        // a new empty chunk in front of next, at the back when next is null
+        Chunk *linkChunkBefore(Chunk *next) {
+            Chunk *chunk = NewChunk();
+            chunk->m_Next = next;
+            chunk->m_Prev = next ? next->m_Prev : m_Tail;
+            (chunk->m_Prev ? chunk->m_Prev->m_Next : m_Head) = chunk;
+            (next ? next->m_Prev : m_Tail) = chunk;
+            return chunk;
+        }
+
+        void unlinkChunk(Chunk *chunk) {
+            (chunk->m_Prev ? chunk->m_Prev->m_Next : m_Head) = chunk->m_Next;
+            (chunk->m_Next ? chunk->m_Next->m_Prev : m_Tail) = chunk->m_Prev;
+            FreeChunk(chunk);
+        }
+
+        // moves count elements from the start of source to the end of target
+        static void MoveElements(Chunk *source, size_t from, Chunk *target, size_t count) {
+            T *begin = source->data() + from;
+            std::uninitialized_move_n(begin, count, target->data() + target->m_Count);
+            std::destroy_n(begin, count);
+            target->m_Count += count;
+        }
+
+        // inserts before position index of chunk (index may be its count), a null chunk means an empty list
+        template<typename... Args>
+        Iterator emplaceAt(Chunk *chunk, size_t index, Args &&... args) {
+            // built first, args may refer to an element that is about to move
+            T value(std::forward<Args>(args)...);
+            if (!chunk) {
+                chunk = linkChunkBefore(nullptr);
+                index = 0;
+            } else if (chunk->m_Count == Capacity) {
+                if (index == 0 && !(chunk->m_Prev && chunk->m_Prev->m_Count < Capacity)) {
+                    chunk = linkChunkBefore(chunk);
+                } else if (index == 0) {
+                    chunk = chunk->m_Prev;
+                    index = chunk->m_Count;
+                } else if (index == Capacity && !(chunk->m_Next && chunk->m_Next->m_Count < Capacity)) {
+                    chunk = linkChunkBefore(chunk->m_Next);
+                    index = 0;
+                } else if (index == Capacity) {
+                    chunk = chunk->m_Next;
+                    index = 0;
+                } else {
+                    // split, the upper half moves into a new chunk
+                    Chunk *upper = linkChunkBefore(chunk->m_Next);
+                    size_t half = Capacity / 2;
+                    MoveElements(chunk, half, upper, Capacity - half);
+                    chunk->m_Count = half;
+                    if (index > half) {
+                        chunk = upper;
+                        index -= half;
+                    }
+                }
+            }
+
+            T *data = chunk->data();
+            size_t count = chunk->m_Count;
+            if (index == count) {
+                ::new(data + count) T(std::move(value));
+            } else {
+                ::new(data + count) T(std::move(data[count - 1]));
+                std::move_backward(data + index, data + count - 1, data + count);
+                data[index] = std::move(value);
+            }
+            ++chunk->m_Count;
+            ++m_Size;
+            return {chunk, index, this};
+        }
+
+        // a chunk that drops below half full takes in its successor when both fit in half a chunk
+        Iterator eraseAt(Chunk *chunk, size_t index) {
+            T *data = chunk->data();
+            std::move(data + index + 1, data + chunk->m_Count, data + index);
+            std::destroy_at(data + --chunk->m_Count);
+            --m_Size;
+
+            if (!chunk->m_Count) {
+                Chunk *next = chunk->m_Next;
+                unlinkChunk(chunk);
+                return {next, 0, this};
+            }
+            if (Chunk *next = chunk->m_Next; next && chunk->m_Count + next->m_Count <= Capacity / 2) {
+                MoveElements(next, 0, chunk, next->m_Count);
+                unlinkChunk(next);
+            }
+            if (index < chunk->m_Count) {
+                return {chunk, index, this};
+            }
+            return {chunk->m_Next, 0, this};
+        }
+
+        // appends count trivially copyable elements stored back to back at data
+        void appendRaw(const uint8_t *data, size_t count) {
+            while (count) {
+                if (!m_Tail || m_Tail->m_Count == Capacity) {
+                    linkChunkBefore(nullptr);
+                }
+                size_t step = std::min(count, Capacity - m_Tail->m_Count);
+                std::memcpy(m_Tail->data() + m_Tail->m_Count, data, step * sizeof(T));
+                m_Tail->m_Count += step;
+                m_Size += step;
+                data += step * sizeof(T);
+                count -= step;
+            }
+        }
+    };
+
+
+    namespace Collectors {
+        inline auto toUnrolledDLList() {
+            return [](auto begin, auto end) {
+                UnrolledDLList<std::remove_reference_t<decltype(*begin)> > list;
+                for (auto it = begin; it != end; ++it) {
+                    list.emplaceBack(std::move(*it));
+                }
+                return list;
+            };
+        }
+    }
+
+    template<typename T, typename ChunkBytes>
+    inline void ReadBufferImpl(DataBuffer &buffer, UnrolledDLList<T, ChunkBytes> &list) {
+        auto size = buffer.read<decltype(list.size())>();
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                list.appendRaw(buffer.consume(Impl::ArrayBytes(size, sizeof(T))), size);
+                return;
+            }
+        }
+        for (size_t i = 0; i < size; ++i) {
+            list.emplaceBack(buffer.read<T>());
+        }
+    }
+
+    template<typename T, typename ChunkBytes>
+    inline void WriteBufferImpl(DataBuffer &buffer, const UnrolledDLList<T, ChunkBytes> &list) {
+        buffer.write(list.size());
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                uint8_t *data = buffer.allocate(list.size() * sizeof(T));
+                list.forEachChunk([&](std::span<const T> chunk) {
+                    std::memcpy(data, chunk.data(), chunk.size_bytes());
+                    data += chunk.size_bytes();
+                });
+                return;
+            }
+        }
+        for (auto &&el: list) {
+            buffer.write<T>(el);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+namespace WayLib {
+    namespace Impl {
+        // tells the core it is in a spin loop, so it backs off and the sibling hyperthread gets the pipeline
+        inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+            _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+            __yield();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+    }
+
+    // Wait strategies park the threads of a lock-free queue until the state they wait for may have changed.
+    // wait(ready) returns once ready() holds, notify() is called after every change that can make it hold; a queue
+    // keeps one strategy per direction, for consumers waiting on data and producers waiting on free space.
+
+    // Burns the core, the lowest latency when every waiter has a core of its own.
+    class SpinWait {
+    public:
+        // after this many pauses the thread also yields its time slice
+        static constexpr size_t YieldAfter = 1024;
+
+        void wait(auto &&ready) {
+            for (size_t spins = 0; !ready(); ++spins) {
+                if (spins < YieldAfter) {
+                    Impl::CpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void notify() {}
+    };
+
+    // Sleeps on an atomic wait (a futex on Linux, WaitOnAddress on Windows). notify() only makes the wake-up call
+    // when some thread is actually asleep, so a busy queue costs a fence and a load per operation.
+    class BlockingWait {
+        std::atomic<uint32_t> m_Version{};
+        std::atomic<uint32_t> m_Waiters{};
+
+    public:
+        void wait(auto &&ready) {
+            while (!ready()) {
+                m_Waiters.fetch_add(1, std::memory_order_relaxed);
+                // pairs with the fence in notify: either this thread sees the change or notify sees the waiter
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                uint32_t version = m_Version.load(std::memory_order_acquire);
+                if (!ready()) {
+                    m_Version.wait(version, std::memory_order_acquire);
+                }
+                m_Waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_Waiters.load(std::memory_order_relaxed)) {
+                m_Version.fetch_add(1, std::memory_order_release);
+                // one change lets one waiter on, the others see the version move and retry or sleep again
+                m_Version.notify_one();
+            }
+        }
+    };
+
+    // Spins for a short while, then sleeps like BlockingWait. The default: hand-offs between busy threads never
+    // reach the kernel, idle threads do not burn their cores.
+    class HybridWait {
+        BlockingWait m_Blocking;
+
+    public:
+        static constexpr size_t SpinCount = 256;
+
+        void wait(auto &&ready) {
+            for (size_t spins = 0; spins < SpinCount; ++spins) {
+                if (ready()) {
+                    return;
+                }
+                Impl::CpuRelax();
+            }
+            m_Blocking.wait(ready);
+        }
+
+        void notify() {
+            m_Blocking.notify();
+        }
+    };
+}
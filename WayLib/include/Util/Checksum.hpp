@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WayLibCrc32cX86
+#include <nmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC emits the intrinsics without a target attribute
+#define WayLibTargetSse42
+#else
+#define WayLibTargetSse42 __attribute__((target("sse4.2")))
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define WayLibCrc32cArm
+#include <arm_acle.h>
+#endif
+
+namespace WayLib::Utils {
+    namespace Impl {
+        // reflected Castagnoli polynomial, the one the SSE4.2 and ARMv8 crc32c instructions implement
+        inline constexpr uint32_t Crc32cPolynomial = 0x82F63B78u;
+
+        // slicing by 8: table k advances a byte that is k positions further from the end of the word
+        constexpr std::array<std::array<uint32_t, 256>, 8> MakeCrc32cTables() {
+            std::array<std::array<uint32_t, 256>, 8> tables{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = crc & 1 ? (crc >> 1) ^ Crc32cPolynomial : crc >> 1;
+                }
+                tables[0][i] = crc;
+            }
+            for (size_t k = 1; k < 8; ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        inline constexpr auto Crc32cTables = MakeCrc32cTables();
+
+        inline uint32_t Crc32cScalar(uint32_t crc, const uint8_t *data, size_t size) {
+            auto &t = Crc32cTables;
+            while (size >= 8) {
+                uint32_t low = static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8
+                               | static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+                low ^= crc;
+                crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+                      ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+                data += 8;
+                size -= 8;
+            }
+            while (size--) {
+                crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+            }
+            return crc;
+        }
+
+#ifdef WayLibCrc32cX86
+        WayLibTargetSse42 inline uint32_t Crc32cHardware(uint32_t crc, const uint8_t *data, size_t size) {
+            uint64_t wide = crc;
+            while (size >= 8) {
+                uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                wide = _mm_crc32_u64(wide, word);
+                data += 8;
+                size -= 8;
+            }
+            crc = static_cast<uint32_t>(wide);
+            while (size--) {
+                crc = _mm_crc32_u8(crc, *data++);
+            }
+            return crc;
+        }
+
+        inline bool HasHardwareCrc32c() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+#else
+            return __builtin_cpu_supports("sse4.2");
+#endif
+        }
+#elif defined(WayLibCrc32cArm)
+        inline uint32_t Crc32cHardware(uint32_t crc, const uint8_t *data, size_t size) {
+            while (size >= 8) {
+                uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                crc = __crc32cd(crc, word);
+                data += 8;
+                size -= 8;
+            }
+            while (size--) {
+                crc = __crc32cb(crc, *data++);
+            }
+            return crc;
+        }
+
+        // the target was compiled with the crc extension, so every CPU it runs on has it
+        inline bool HasHardwareCrc32c() {
+            return true;
+        }
+#endif
+    }
+
+    // CRC32C (Castagnoli) of size bytes. Uses the SSE4.2 / ARMv8 crc32c instruction when the CPU has it, checked once
+    // at runtime on x86, and a table driven slicing by 8 loop otherwise; both give the same result.
+    // Pass a previous result as crc to continue a checksum over data that arrives in pieces.
+    inline uint32_t Crc32c(const void *data, size_t size, uint32_t crc = 0) {
+        auto *bytes = static_cast<const uint8_t *>(data);
+#if defined(WayLibCrc32cX86) || defined(WayLibCrc32cArm)
+        static const bool hardware = Impl::HasHardwareCrc32c();
+        if (hardware) {
+            return ~Impl::Crc32cHardware(~crc, bytes, size);
+        }
+#endif
+        return ~Impl::Crc32cScalar(~crc, bytes, size);
+    }
+}
+
+#undef WayLibTargetSse42
+#undef WayLibCrc32cX86
+#undef WayLibCrc32cArm
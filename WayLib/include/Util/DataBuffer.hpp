@@ -1,12 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <ostream>
 #include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "Exceptions.hpp"
+#include "Serializable.hpp"
 #include "RuntimeException.hpp"
 #include "CRTP/inject_container_traits.hpp"
 #include "Macro/DefWayMacro.hpp"
@@ -20,6 +35,11 @@ namespace WayLib {
     template<typename T, typename _ = void>
     void ReadBufferImpl(DataBuffer &buffer, T &ref);
 
+    // Expected number of bytes WriteBufferImpl produces for a value, in O(1). Exact for scalars, strings and
+    // containers of bulk serializable elements, an estimate from the element type for everything else.
+    template<typename T>
+    size_t SerializedSizeHint(const T &value);
+
     class BufferOverflowException : public RuntimeException {
     public:
         DeclWayLibExceptionConstructors(BufferOverflowException, "DataBuffer Overflow")
@@ -28,6 +48,295 @@ namespace WayLib {
             return "WayLib::DataBuffer::BufferOverflowException";
         }
     };
+
+    // Native writes integers and floating point values as their raw in-memory bytes.
+    // Compact writes integers wider than one byte (enums included, length prefixes included) as LEB128 varints,
+    // signed ones zigzag encoded first, and floating point values in little endian byte order. Everything else,
+    // strings' characters and trivially copyable structs for example, is written the same way in both modes.
+    enum class DataBufferEncoding : uint8_t {
+        Native,
+        Compact
+    };
+
+    // define WAYLIB_DATABUFFER_COMPACT to make Compact the encoding of every buffer that does not choose one
+#ifdef WAYLIB_DATABUFFER_COMPACT
+    inline constexpr DataBufferEncoding DefaultDataBufferEncoding = DataBufferEncoding::Compact;
+#else
+    inline constexpr DataBufferEncoding DefaultDataBufferEncoding = DataBufferEncoding::Native;
+#endif
+
+    namespace Impl {
+        // types whose Compact encoding differs from their raw bytes
+        template<typename T>
+        inline constexpr bool IsCompactEncoded =
+                ((std::is_integral_v<T> || std::is_enum_v<T>) && sizeof(T) > 1 && !std::is_same_v<T, bool>)
+                || (std::is_floating_point_v<T> && std::endian::native != std::endian::little);
+
+        inline constexpr size_t MaxVarintSize = 10;
+
+        inline size_t EncodeVarint(uint64_t value, uint8_t *out) {
+            size_t size = 0;
+            while (value >= 0x80) {
+                out[size++] = static_cast<uint8_t>(value) | 0x80;
+                value >>= 7;
+            }
+            out[size++] = static_cast<uint8_t>(value);
+            return size;
+        }
+
+        // returns the number of bytes consumed, 0 if the varint is truncated or longer than 64 bits
+        inline size_t DecodeVarint(const uint8_t *data, size_t available, uint64_t &value) {
+            value = 0;
+            size_t limit = std::min(available, MaxVarintSize);
+            for (size_t i = 0; i < limit; ++i) {
+                value |= static_cast<uint64_t>(data[i] & 0x7F) << (7 * i);
+                if (!(data[i] & 0x80)) {
+                    return i + 1;
+                }
+            }
+            return 0;
+        }
+
+        template<typename T>
+        uint64_t ToVarintValue(T value) {
+            if constexpr (std::is_enum_v<T>) {
+                return ToVarintValue(static_cast<std::underlying_type_t<T> >(value));
+            } else if constexpr (std::is_signed_v<T>) {
+                auto wide = static_cast<int64_t>(value);
+                return (static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63);
+            } else {
+                return static_cast<uint64_t>(value);
+            }
+        }
+
+        // false if the decoded value does not fit in T
+        template<typename T>
+        bool FromVarintValue(uint64_t encoded, T &value) {
+            if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> underlying;
+                bool fits = FromVarintValue(encoded, underlying);
+                value = static_cast<T>(underlying);
+                return fits;
+            } else if constexpr (std::is_signed_v<T>) {
+                auto wide = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+                value = static_cast<T>(wide);
+                return wide >= std::numeric_limits<T>::min() && wide <= std::numeric_limits<T>::max();
+            } else {
+                value = static_cast<T>(encoded);
+                return encoded <= std::numeric_limits<T>::max();
+            }
+        }
+
+        // the value's bytes in little endian order, for floating point values in Compact mode
+        template<typename T>
+        void ToLittleEndian(const T &value, uint8_t *out) {
+            std::memcpy(out, &value, sizeof(T));
+            if constexpr (std::endian::native != std::endian::little) {
+                std::reverse(out, out + sizeof(T));
+            }
+        }
+
+        template<typename T>
+        T FromLittleEndian(const uint8_t *in) {
+            uint8_t bytes[sizeof(T)];
+            std::memcpy(bytes, in, sizeof(T));
+            if constexpr (std::endian::native != std::endian::little) {
+                std::reverse(bytes, bytes + sizeof(T));
+            }
+            T value;
+            std::memcpy(&value, bytes, sizeof(T));
+            return value;
+        }
+    }
+
+    // Non-owning reader over bytes in the DataBuffer wire format. Strings and spans of trivially copyable elements
+    // are handed out in place, every field costs one bounds check no matter how long it is.
+    // The viewed bytes must outlive the view and everything read from it.
+    class DataBufferView {
+        std::span<const uint8_t> m_Data;
+        size_t m_ReadIndex{};
+        DataBufferEncoding m_Encoding{DefaultDataBufferEncoding};
+
+        using SizeType = decltype(std::string{}.size());
+
+    public:
+        DataBufferView() = default;
+
+        explicit DataBufferView(std::span<const uint8_t> data,
+                                DataBufferEncoding encoding = DefaultDataBufferEncoding)
+            : m_Data(data), m_Encoding(encoding) {}
+
+        DataBufferView(const void *data, size_t size, DataBufferEncoding encoding = DefaultDataBufferEncoding)
+            : m_Data(static_cast<const uint8_t *>(data), size), m_Encoding(encoding) {}
+
+        [[nodiscard]] DataBufferEncoding getEncoding() const {
+            return m_Encoding;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return m_Data.size();
+        }
+
+        [[nodiscard]] size_t remaining() const {
+            return m_Data.size() - m_ReadIndex;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return m_ReadIndex >= m_Data.size();
+        }
+
+        size_t &getReadIndex() {
+            return m_ReadIndex;
+        }
+
+        [[nodiscard]] std::span<const uint8_t> getData() const {
+            return m_Data;
+        }
+
+        void checkSize(size_t size) const {
+            if (size > m_Data.size() - m_ReadIndex) {
+                throw BufferOverflowException(
+                    "DataBufferView overflow after checking, requested size: " + std::to_string(size) +
+                    ", available size: " + std::to_string(m_Data.size() - m_ReadIndex) +
+                    ", read index: " + std::to_string(m_ReadIndex));
+            }
+        }
+
+        std::span<const uint8_t> readBytes(size_t size) {
+            checkSize(size);
+            auto bytes = m_Data.subspan(m_ReadIndex, size);
+            m_ReadIndex += size;
+            return bytes;
+        }
+
+        // same layout as DataBuffer's std::string: the size, then the characters
+        std::string_view readStringView() {
+            auto size = read<SizeType>();
+            auto bytes = readBytes(size);
+            return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+        }
+
+        // same layout as DataBuffer's std::vector<T>; the elements are only usable in place when they happen to be
+        // aligned for T (and stored raw, not as Compact varints), otherwise an IllegalArgumentException is thrown,
+        // the read index is left where it was and read<std::vector<T>>() has to be used
+        template<typename T>
+        std::span<const T> readSpan() {
+            static_assert(std::is_trivially_copyable_v<T>, "readSpan requires a trivially copyable element type");
+            if (m_Encoding == DataBufferEncoding::Compact && Impl::IsCompactEncoded<T>) {
+                throw IllegalArgumentException("DataBufferView::readSpan: elements are varint encoded in Compact mode");
+            }
+            size_t start = m_ReadIndex;
+            auto count = read<SizeType>();
+            checkCount(count, sizeof(T));
+            const uint8_t *begin = m_Data.data() + m_ReadIndex;
+            if (reinterpret_cast<uintptr_t>(begin) % alignof(T)) {
+                m_ReadIndex = start;
+                throw IllegalArgumentException(
+                    "DataBufferView::readSpan: payload at read index " + std::to_string(m_ReadIndex) +
+                    " is not aligned to " + std::to_string(alignof(T)) + " bytes");
+            }
+            m_ReadIndex += count * sizeof(T);
+            return {reinterpret_cast<const T *>(begin), count};
+        }
+
+        // copies out trivially copyable values, std::string and std::vector of trivially copyable elements
+        template<typename T>
+        T read() {
+            if constexpr (std::is_same_v<T, std::string>) {
+                return std::string(readStringView());
+            } else if constexpr (IsVectorOfTrivial<T>::value) {
+                using E = typename T::value_type;
+                auto count = read<SizeType>();
+                if (m_Encoding == DataBufferEncoding::Compact && Impl::IsCompactEncoded<E>) {
+                    // every element takes at least one byte
+                    checkCount(count, 1);
+                    T result;
+                    result.reserve(count);
+                    for (size_t i = 0; i < count; ++i) {
+                        result.push_back(read<E>());
+                    }
+                    return result;
+                }
+                checkCount(count, sizeof(E));
+                T result(count);
+                if (count) {
+                    std::memcpy(result.data(), m_Data.data() + m_ReadIndex, count * sizeof(E));
+                }
+                m_ReadIndex += count * sizeof(E);
+                return result;
+            } else {
+                static_assert(std::is_trivially_copyable_v<T>,
+                              "DataBufferView can only read trivially copyable types, std::string and std::vector");
+                T result;
+                if constexpr (Impl::IsCompactEncoded<T>) {
+                    if (m_Encoding == DataBufferEncoding::Compact) {
+                        readCompact(result);
+                        return result;
+                    }
+                }
+                std::memcpy(&result, readBytes(sizeof(T)).data(), sizeof(T));
+                return result;
+            }
+        }
+
+        template<typename T>
+        DataBufferView &read(T &ref) {
+            ref = read<T>();
+            return *this;
+        }
+
+        DataBufferView &read(std::string_view &ref) {
+            ref = readStringView();
+            return *this;
+        }
+
+        template<typename T>
+        DataBufferView &read(std::span<const T> &ref) {
+            ref = readSpan<T>();
+            return *this;
+        }
+
+        DataBufferView &popFront(auto &... args) {
+            (read(args), ...);
+            return *this;
+        }
+
+    private:
+        template<typename T>
+        void readCompact(T &value) {
+            if constexpr (std::is_floating_point_v<T>) {
+                uint8_t bytes[sizeof(T)];
+                std::memcpy(bytes, readBytes(sizeof(T)).data(), sizeof(T));
+                std::reverse(bytes, bytes + sizeof(T));
+                std::memcpy(&value, bytes, sizeof(T));
+            } else {
+                uint64_t encoded;
+                size_t size = Impl::DecodeVarint(m_Data.data() + m_ReadIndex, remaining(), encoded);
+                if (!size || !Impl::FromVarintValue(encoded, value)) {
+                    throw BufferOverflowException(
+                        "DataBufferView: malformed varint at read index " + std::to_string(m_ReadIndex));
+                }
+                m_ReadIndex += size;
+            }
+        }
+
+        // count * elementSize could overflow for a corrupt count, so compare against the element count instead
+        void checkCount(size_t count, size_t elementSize) const {
+            if (count > remaining() / elementSize) {
+                throw BufferOverflowException(
+                    "DataBufferView overflow after checking, requested elements: " + std::to_string(count) +
+                    " of size " + std::to_string(elementSize) + ", available size: " + std::to_string(remaining()) +
+                    ", read index: " + std::to_string(m_ReadIndex));
+            }
+        }
+
+        template<typename T>
+        struct IsVectorOfTrivial : std::false_type {};
+
+        template<typename E, typename A>
+        struct IsVectorOfTrivial<std::vector<E, A> >
+                : std::bool_constant<std::is_trivially_copyable_v<E> && !std::is_same_v<E, bool> > {};
+    };
 }
 
 inline WayLib::DataBuffer &&operator>>(WayLib::DataBuffer &&buffer, auto &data);
@@ -39,18 +348,86 @@ inline WayLib::DataBuffer &operator>>(WayLib::DataBuffer &buffer, auto &data);
 inline WayLib::DataBuffer &operator<<(WayLib::DataBuffer &buffer, const auto &data);
 
 namespace WayLib {
+    // Element types whose DataBuffer encoding is exactly their object representation, so vectors, arrays and lists of
+    // them are written and read as one block. Specialize to std::false_type for a trivially copyable type that has its
+    // own WriteBufferImpl / ReadBufferImpl. bool is excluded, any byte other than 0 or 1 would be an invalid bool.
+    // So are DeclWayLibSerializable structs, which are written field by field and never include their padding.
+    namespace Impl {
+        template<typename T, typename = void>
+        struct HasSerializableFields : std::false_type {};
+
+        template<typename T>
+        struct HasSerializableFields<T, std::void_t<decltype(T::WayLibSerializableFields())> > : std::true_type {};
+    }
+
+    template<typename T>
+    struct IsBulkSerializable : std::bool_constant<std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>
+                                                   && !Impl::HasSerializableFields<T>::value> {};
+
+    template<typename T>
+    inline constexpr bool IsBulkSerializableV = IsBulkSerializable<T>::value;
+
+    // Turns the value-initialization done by resize into default-initialization, so growing a byte vector leaves the
+    // new bytes uninitialized instead of zero filling memory that is about to be overwritten anyway.
+    template<typename T, typename Alloc = std::allocator<T> >
+    class DefaultInitAllocator : public Alloc {
+        using Traits = std::allocator_traits<Alloc>;
+
+    public:
+        template<typename U>
+        struct rebind {
+            using other = DefaultInitAllocator<U, typename Traits::template rebind_alloc<U> >;
+        };
+
+        using Alloc::Alloc;
+
+        template<typename U>
+        void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+            ::new(static_cast<void *>(ptr)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U *ptr, Args &&... args) {
+            Traits::construct(static_cast<Alloc &>(*this), ptr, std::forward<Args>(args)...);
+        }
+    };
+
+    namespace Impl {
+        // byte size of count elements, saturated so a corrupt count fails the bounds check instead of wrapping around
+        inline size_t ArrayBytes(size_t count, size_t elementSize) {
+            return count > SIZE_MAX / elementSize ? SIZE_MAX : count * elementSize;
+        }
+    }
+
     class DataBuffer : public inject_type_converts {
-        std::vector<uint8_t> m_Data;
+    public:
+        using Storage = std::vector<uint8_t, DefaultInitAllocator<uint8_t> >;
+
+    private:
+        Storage m_Data;
 
         size_t m_ReadIndex{};
 
+        DataBufferEncoding m_Encoding{DefaultDataBufferEncoding};
+
+        // read-only bytes owned by someone else (a mapped file for example), used instead of m_Data while set
+        std::shared_ptr<const void> m_External{};
+        const uint8_t *m_ExternalData{};
+        size_t m_ExternalSize{};
+
     private:
-        DataBuffer(const DataBuffer &rhs) : m_Data(rhs.m_Data) {
+        DataBuffer(const DataBuffer &rhs) : m_Data(rhs.m_Data), m_Encoding(rhs.m_Encoding),
+                                            m_External(rhs.m_External), m_ExternalData(rhs.m_ExternalData),
+                                            m_ExternalSize(rhs.m_ExternalSize) {
         }
 
         DataBuffer &operator=(const DataBuffer &rhs) {
             m_Data = rhs.m_Data;
             m_ReadIndex = 0;
+            m_Encoding = rhs.m_Encoding;
+            m_External = rhs.m_External;
+            m_ExternalData = rhs.m_ExternalData;
+            m_ExternalSize = rhs.m_ExternalSize;
             return *this;
         }
 
@@ -71,9 +448,17 @@ namespace WayLib {
             return copy;
         }
 
+        // grows the buffer by size bytes and returns where they start, the caller fills them in
+        uint8_t *allocate(_declself_, size_t size) {
+            self.materialize();
+            self.m_Data.resize(self.m_Data.size() + size);
+            return self.m_Data.data() + self.m_Data.size() - size;
+        }
+
         decltype(auto) simpleAppend(_declself_, const void *data, size_t size) {
-            _self_.m_Data.resize(_self_.m_Data.size() + size);
-            std::memcpy(_self_.m_Data.data() + _self_.m_Data.size() - size, data, size);
+            if (size) {
+                std::memcpy(_self_.allocate(size), data, size);
+            }
             return _self_;
         }
 
@@ -86,6 +471,123 @@ namespace WayLib {
 
         DataBuffer() = default;
 
+        explicit DataBuffer(DataBufferEncoding encoding) : m_Encoding(encoding) {}
+
+        // takes over storage as the buffer's content, e.g. a cleared Storage handed out by DataBufferPool
+        explicit DataBuffer(Storage storage, DataBufferEncoding encoding = DefaultDataBufferEncoding)
+            : m_Data(std::move(storage)), m_Encoding(encoding) {}
+
+        DataBufferEncoding getEncoding(_declself_) {
+            return _self_.m_Encoding;
+        }
+
+        // only meaningful while the buffer is empty, bytes already written keep the encoding they were written with
+        decltype(auto) setEncoding(_declself_, DataBufferEncoding encoding) {
+            _self_.m_Encoding = encoding;
+            return _self_;
+        }
+
+        bool isCompact(_declself_) {
+            return _self_.m_Encoding == DataBufferEncoding::Compact;
+        }
+
+        // false when T has to be written one element at a time because Compact mode encodes it differently
+        template<typename T>
+        bool canCopyRaw(_declself_) {
+            if constexpr (Impl::IsCompactEncoded<T>) {
+                return !_self_.isCompact();
+            } else {
+                return true;
+            }
+        }
+
+        decltype(auto) writeVarint(_declself_, uint64_t value) {
+            uint8_t bytes[Impl::MaxVarintSize];
+            _self_.simpleAppend(bytes, Impl::EncodeVarint(value, bytes));
+            return _self_;
+        }
+
+        uint64_t readVarint(_declself_) {
+            uint64_t value;
+            size_t size = Impl::DecodeVarint(self.data() + self.m_ReadIndex, self.size() - self.m_ReadIndex, value);
+            if (!size) {
+                throw BufferOverflowException(
+                    "DataBuffer malformed or truncated varint at read index " + std::to_string(self.m_ReadIndex));
+            }
+            self.m_ReadIndex += size;
+            return value;
+        }
+        // Reads straight from bytes the buffer does not own, e.g. a memory mapped file, owner keeps them alive. Nothing
+        // is copied until the buffer is first modified (or its Storage is asked for), then the bytes are copied into m_Data.
+        DataBuffer(std::span<const uint8_t> bytes, std::shared_ptr<const void> owner,
+                   DataBufferEncoding encoding = DefaultDataBufferEncoding)
+            : m_Encoding(encoding), m_External(std::move(owner)), m_ExternalData(bytes.data()),
+              m_ExternalSize(bytes.size()) {
+            if (!m_External) {
+                // not owned by anyone, the caller guarantees the bytes outlive the buffer
+                m_External = std::shared_ptr<const void>(m_ExternalData, [](const void *) {});
+            }
+        }
+
+        bool isExternal(_declself_) {
+            return static_cast<bool>(_self_.m_External);
+        }
+
+        // start of the content, whether it is owned or external
+        const uint8_t *data(_declself_) {
+            return self.m_External ? self.m_ExternalData : self.m_Data.data();
+        }
+
+        // gives the storage (and its allocation) away, the buffer is left empty
+        Storage releaseStorage(_declself_) {
+            self.materialize();
+            self.m_ReadIndex = 0;
+            return std::exchange(self.m_Data, Storage());
+        }
+
+        size_t size(_declself_) {
+            return self.m_External ? self.m_ExternalSize : self.m_Data.size();
+        }
+
+        size_t capacity(_declself_) {
+            return _self_.m_Data.capacity();
+        }
+
+        decltype(auto) reserve(_declself_, size_t capacity) {
+            _self_.materialize();
+            _self_.m_Data.reserve(capacity);
+            return _self_;
+        }
+
+        // makes room for values about to be written, using SerializedSizeHint, so a message is not assembled through
+        // a chain of reallocations
+        decltype(auto) reserveFor(_declself_, const auto &... values) {
+            _self_.materialize();
+            _self_.grow(_self_.m_Data.size() + (size_t{} + ... + SerializedSizeHint(values)));
+            return _self_;
+        }
+
+        decltype(auto) shrinkToFit(_declself_) {
+            _self_.m_Data.shrink_to_fit();
+            return _self_;
+        }
+
+        // drops the content but keeps the allocation, for reusing one buffer across many messages
+        decltype(auto) clear(_declself_) {
+            _self_.dropExternal();
+            _self_.m_Data.clear();
+            _self_.m_ReadIndex = 0;
+            return _self_;
+        }
+
+        // drops the content and releases the allocation
+        decltype(auto) reset(_declself_) {
+            _self_.dropExternal();
+            Storage().swap(_self_.m_Data);
+            _self_.m_ReadIndex = 0;
+            return _self_;
+        }
+
         template<typename T>
         decltype(auto) write(_declself_, const T &data) {
             WriteBufferImpl(self, _forward_(data));
@@ -107,6 +609,9 @@ namespace WayLib {
         }
 
         decltype(auto) pushBack(_declself_, auto &&... args) {
+            if constexpr (sizeof...(args) > 1) {
+                _self_.reserveFor(args...);
+            }
             (_self_.write(_forward_(args)), ...);
             return _self_;
         }
@@ -117,23 +622,40 @@ namespace WayLib {
         }
 
         decltype(auto) operator[](_declself_, size_t index) {
-            return _self_.m_Data[index];
+            if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)> >) {
+                return self.data()[index];
+            } else {
+                self.materialize();
+                return _self_.m_Data[index];
+            }
         }
 
+        // The owned storage for writing; an external buffer copies its bytes in first. A const buffer only gives
+        // a read-only span over the content and never copies, so concurrent readers are safe.
         decltype(auto) getData(_declself_) {
-            return _self_.m_Data;
+            if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)> >) {
+                return std::span<const uint8_t>(self.data(), self.size());
+            } else {
+                self.materialize();
+                return (_self_.m_Data);
+            }
         }
 
-        std::pair<void *, size_t> getRawData(_declself_) {
-            return std::make_pair(_self_.m_Data.data(), _self_.m_Data.size() * sizeof(uint8_t));
+        auto getRawData(_declself_) {
+            if constexpr (std::is_const_v<std::remove_reference_t<decltype(self)> >) {
+                return std::make_pair(static_cast<const void *>(self.data()), self.size());
+            } else {
+                self.materialize();
+                return std::make_pair(static_cast<void *>(self.m_Data.data()), self.m_Data.size() * sizeof(uint8_t));
+            }
         }
 
         void checkSize(_declself_, size_t size) {
-            if (_self_.m_ReadIndex + size > _self_.m_Data.size()) {
+            if (size > _self_.size() - _self_.m_ReadIndex) {
                 throw BufferOverflowException(
                             "DataBuffer overflow after checking, requested size: " + std::to_string(size) +
                             ", available size: " + std::to_string(
-                                _self_.m_Data.size() - _self_.m_ReadIndex) + std::string(", read index: ") +
+                                _self_.size() - _self_.m_ReadIndex) + std::string(", read index: ") +
                             std::to_string(_self_.m_ReadIndex))
                         .pushOptionalData("DataBuffer", std::make_shared<DataBuffer>(_self_.move()));
             }
@@ -143,29 +665,241 @@ namespace WayLib {
             return _self_.m_ReadIndex;
         }
 
+        // checks that size more bytes can be read, then returns where they start and moves the read index past them
+        const uint8_t *consume(_declself_, size_t size) {
+            self.checkSize(size);
+            const uint8_t *data = self.data() + self.m_ReadIndex;
+            self.m_ReadIndex += size;
+            return data;
+        }
+
+        // a view of the unread part, reading from it does not move this buffer's read index
+        DataBufferView view(_declself_) {
+            return DataBufferView(_self_.data() + _self_.m_ReadIndex, _self_.size() - _self_.m_ReadIndex,
+                                  _self_.m_Encoding);
+        }
+
         void writeToStream(_declself_, std::ostream &os) {
-            os.write(reinterpret_cast<const char *>(_self_.m_Data.data()), _self_.m_Data.size());
+            os.write(reinterpret_cast<const char *>(_self_.data()), _self_.size());
+        }
+
+    private:
+        void materialize() {
+            if (m_External) {
+                m_Data.assign(m_ExternalData, m_ExternalData + m_ExternalSize);
+                dropExternal();
+            }
+        }
+
+        void dropExternal() {
+            m_External.reset();
+            m_ExternalData = nullptr;
+            m_ExternalSize = 0;
+        }
+
+        // reserve() alone would allocate exactly what is asked for on every call, this keeps the growth geometric
+        void grow(size_t required) {
+            if (required > m_Data.capacity()) {
+                m_Data.reserve(std::max(required, m_Data.capacity() * 2));
+            }
         }
     };
 
+    // reads the rest of the stream straight into the buffer's storage, in one allocation when the stream is seekable
     inline DataBuffer CreateBufferFromStream(std::istream &is) {
+        constexpr size_t ChunkSize = 64 * 1024;
+
         DataBuffer buffer;
-        std::stringstream ss;
-        ss << is.rdbuf();
-        buffer.simpleAppend(ss.str().data(), ss.str().size());
+        auto &data = buffer.getData();
+        if (auto begin = is.tellg(); begin != std::streampos(-1)) {
+            is.seekg(0, std::ios::end);
+            auto end = is.tellg();
+            is.seekg(begin);
+            if (end != std::streampos(-1) && end > begin) {
+                data.reserve(static_cast<size_t>(end - begin));
+            }
+        }
+        is.clear();
+
+        while (true) {
+            size_t size = data.size();
+            size_t chunk = std::max(ChunkSize, data.capacity() - size);
+            data.resize(size + chunk);
+            is.read(reinterpret_cast<char *>(data.data() + size), static_cast<std::streamsize>(chunk));
+            auto count = static_cast<size_t>(is.gcount());
+            data.resize(size + count);
+            if (count < chunk || is.peek() == std::istream::traits_type::eof()) {
+                break;
+            }
+        }
         return buffer;
     }
 
+    namespace Impl {
+        template<typename T>
+        struct IsStdArray : std::false_type {};
+
+        template<typename T, size_t N>
+        struct IsStdArray<std::array<T, N> > : std::true_type {};
+
+        template<typename T, typename = void>
+        struct HasSizeMember : std::false_type {};
+
+        template<typename T>
+        struct HasSizeMember<T, std::void_t<decltype(std::declval<const T &>().size()), typename T::value_type> >
+                : std::true_type {};
+    }
+
+    namespace Impl {
+        // compile time layout of a DeclWayLibSerializable field list
+        template<typename Fields>
+        struct FieldLayout;
+
+        template<typename... Fields>
+        struct FieldLayout<std::tuple<Fields...> > {
+            static constexpr size_t Count = sizeof...(Fields);
+            static constexpr std::array<bool, Count> Raw{IsBulkSerializableV<typename Fields::Type>...};
+            static constexpr std::array<size_t, Count> Offsets{Fields::Offset...};
+            static constexpr std::array<size_t, Count> Sizes{sizeof(typename Fields::Type)...};
+            static constexpr bool AnyCompactEncoded = (IsCompactEncoded<typename Fields::Type> || ...);
+
+            static constexpr bool Adjacent(size_t index) {
+                return index > 0 && Raw[index - 1] && Raw[index]
+                       && Offsets[index - 1] + Sizes[index - 1] == Offsets[index];
+            }
+
+            // bytes covered by the run of adjacent raw fields starting at index, 0 if index continues an earlier run
+            static constexpr size_t RunBytes(size_t index) {
+                if (!Raw[index] || Adjacent(index)) {
+                    return 0;
+                }
+                size_t last = index;
+                while (last + 1 < Count && Adjacent(last + 1)) {
+                    ++last;
+                }
+                return Offsets[last] + Sizes[last] - Offsets[index];
+            }
+        };
+
+        template<typename T>
+        using FieldsOf = decltype(T::WayLibSerializableFields());
+
+        template<typename T, size_t... I>
+        void WriteFieldRuns(DataBuffer &buffer, const T &data, std::index_sequence<I...>) {
+            using Layout = FieldLayout<FieldsOf<T> >;
+            ([&] {
+                using Field = std::tuple_element_t<I, FieldsOf<T> >;
+                if constexpr (!Layout::Raw[I]) {
+                    buffer.write(Field::get(data));
+                } else if constexpr (Layout::RunBytes(I) != 0) {
+                    buffer.simpleAppend(reinterpret_cast<const uint8_t *>(&data) + Field::Offset, Layout::RunBytes(I));
+                }
+            }(), ...);
+        }
+
+        template<typename T, size_t... I>
+        void ReadFieldRuns(DataBuffer &buffer, T &ref, std::index_sequence<I...>) {
+            using Layout = FieldLayout<FieldsOf<T> >;
+            ([&] {
+                using Field = std::tuple_element_t<I, FieldsOf<T> >;
+                if constexpr (!Layout::Raw[I]) {
+                    buffer.read(Field::get(ref));
+                } else if constexpr (Layout::RunBytes(I) != 0) {
+                    std::memcpy(reinterpret_cast<uint8_t *>(&ref) + Field::Offset, buffer.consume(Layout::RunBytes(I)),
+                                Layout::RunBytes(I));
+                }
+            }(), ...);
+        }
+
+        // Compact mode encodes some fields differently from their memory, those structs go one field at a time
+        template<typename T>
+        void WriteSerializableFields(DataBuffer &buffer, const T &data) {
+            using Layout = FieldLayout<FieldsOf<T> >;
+            if (Layout::AnyCompactEncoded && buffer.isCompact()) {
+                std::apply([&](auto... field) {
+                    (buffer.write(field.get(data)), ...);
+                }, FieldsOf<T>{});
+                return;
+            }
+            WriteFieldRuns(buffer, data, std::make_index_sequence<Layout::Count>{});
+        }
+
+        template<typename T>
+        void ReadSerializableFields(DataBuffer &buffer, T &ref) {
+            using Layout = FieldLayout<FieldsOf<T> >;
+            if (Layout::AnyCompactEncoded && buffer.isCompact()) {
+                std::apply([&](auto... field) {
+                    (buffer.read(field.get(ref)), ...);
+                }, FieldsOf<T>{});
+                return;
+            }
+            ReadFieldRuns(buffer, ref, std::make_index_sequence<Layout::Count>{});
+        }
+    }
+
+    template<typename T>
+    size_t SerializedSizeHint(const T &value) {
+        if constexpr (Impl::HasSerializableFields<T>::value) {
+            return std::apply([&](auto... field) {
+                return (size_t{} + ... + SerializedSizeHint(field.get(value)));
+            }, Impl::FieldsOf<T>{});
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return sizeof(value.size()) + value.size();
+        } else if constexpr (Impl::IsStdArray<T>::value) {
+            return value.size() * sizeof(typename T::value_type);
+        } else if constexpr (Impl::HasSizeMember<T>::value) {
+            // containers: the size prefix and size() elements, which are counted by type rather than walked
+            return sizeof(value.size()) + value.size() * sizeof(typename T::value_type);
+        } else {
+            return sizeof(T);
+        }
+    }
+
     template<typename T, typename _>
     void WriteBufferImpl(DataBuffer &buffer, const T &data) {
+        if constexpr (Impl::HasSerializableFields<T>::value) {
+            Impl::WriteSerializableFields(buffer, data);
+            return;
+        }
+        if constexpr (Impl::IsCompactEncoded<T>) {
+            if (buffer.isCompact()) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    Impl::ToLittleEndian(data, buffer.allocate(sizeof(T)));
+                } else {
+                    buffer.writeVarint(Impl::ToVarintValue(data));
+                }
+                return;
+            }
+        }
         buffer.simpleAppend(&data);
     }
 
     template<typename T, typename _>
     void ReadBufferImpl(DataBuffer &buffer, T &ref) {
-        buffer.checkSize(sizeof(T));
-        ref = reinterpret_cast<T &>(buffer.getData()[buffer.getReadIndex()]);
-        buffer.getReadIndex() += sizeof(T);
+        if constexpr (Impl::HasSerializableFields<T>::value) {
+            Impl::ReadSerializableFields(buffer, ref);
+            return;
+        }
+        if constexpr (Impl::IsCompactEncoded<T>) {
+            if (buffer.isCompact()) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    uint8_t bytes[sizeof(T)];
+                    std::memcpy(bytes, buffer.consume(sizeof(T)), sizeof(T));
+                    std::reverse(bytes, bytes + sizeof(T));
+                    std::memcpy(&ref, bytes, sizeof(T));
+                } else if (!Impl::FromVarintValue(buffer.readVarint(), ref)) {
+                    throw BufferOverflowException("DataBuffer varint does not fit in the type being read");
+                }
+                return;
+            }
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(&ref, buffer.consume(sizeof(T)), sizeof(T));
+        } else {
+            buffer.checkSize(sizeof(T));
+            ref = *reinterpret_cast<const T *>(buffer.data() + buffer.getReadIndex());
+            buffer.getReadIndex() += sizeof(T);
+        }
     }
 
     // std::string
@@ -195,10 +929,7 @@ namespace WayLib {
     template<>
     inline void ReadBufferImpl(DataBuffer &buffer, std::string &ref) {
         auto size = buffer.read<decltype(std::string{}.size())>();
-        ref.reserve(size);
-        for (size_t i = 0; i < size; ++i) {
-            ref.push_back(buffer.read<char>());
-        }
+        ref.assign(reinterpret_cast<const char *>(buffer.consume(size)), size);
     }
 
     // vector<T>
@@ -206,6 +937,12 @@ namespace WayLib {
     template<typename T>
     inline void WriteBufferImpl(DataBuffer &buffer, const std::vector<T> &data) {
         buffer.write(data.size());
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                buffer.simpleAppend(data.data(), data.size() * sizeof(T));
+                return;
+            }
+        }
         for (auto &&el: data) {
             buffer.write(el);
         }
@@ -214,7 +951,20 @@ namespace WayLib {
     template<typename T>
     inline void ReadBufferImpl(DataBuffer &buffer, std::vector<T> &ref) {
         auto size = buffer.read<decltype(std::vector<T>{}.size())>();
-        ref.reserve(size);
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                const uint8_t *data = buffer.consume(Impl::ArrayBytes(size, sizeof(T)));
+                size_t offset = ref.size();
+                if (size) {
+                    ref.resize(offset + size);
+                    std::memcpy(ref.data() + offset, data, size * sizeof(T));
+                }
+                return;
+            }
+            // every Compact element takes at least one byte
+            buffer.checkSize(size);
+        }
+        ref.reserve(ref.size() + size);
         for (size_t i = 0; i < size; ++i) {
             ref.emplace_back(buffer.read<T>());
         }
@@ -331,6 +1081,12 @@ namespace WayLib {
 
     template<typename T, size_t N>
     inline void WriteBufferImpl(DataBuffer &buffer, const std::array<T, N> &data) {
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                buffer.simpleAppend(data.data(), N * sizeof(T));
+                return;
+            }
+        }
         for (auto &&el: data) {
             buffer.write(el);
         }
@@ -338,6 +1094,12 @@ namespace WayLib {
 
     template<typename T, size_t N>
     inline void ReadBufferImpl(DataBuffer &buffer, std::array<T, N> &ref) {
+        if constexpr (IsBulkSerializableV<T>) {
+            if (buffer.canCopyRaw<T>()) {
+                std::memcpy(ref.data(), buffer.consume(N * sizeof(T)), N * sizeof(T));
+                return;
+            }
+        }
         for (size_t i = 0; i < N; ++i) {
             ref[i] = buffer.read<T>();
         }
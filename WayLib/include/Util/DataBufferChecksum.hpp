@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "Checksum.hpp"
+#include "DataBuffer.hpp"
+
+// Checksummed frames, so a damaged file or message is reported as such before anything is decoded from it:
+//     frame := size:u32le crc:u32le payload      crc is the CRC32C of size's four bytes followed by the payload
+namespace WayLib {
+    class ChecksumMismatchException : public RuntimeException {
+    public:
+        DeclWayLibExceptionConstructors(ChecksumMismatchException, "DataBuffer Checksum Mismatch")
+
+        [[nodiscard]] std::string exceptionType() const override {
+            return "WayLib::DataBuffer::ChecksumMismatchException";
+        }
+    };
+
+    // Everything written through it goes straight into buffer as the payload of one frame, the header is filled in
+    // by finish() or the destructor.
+    class ChecksummedFrameWriter {
+        DataBuffer &m_Buffer;
+        size_t m_HeaderOffset;
+        bool m_Open{true};
+
+    public:
+        explicit ChecksummedFrameWriter(DataBuffer &buffer) : m_Buffer(buffer), m_HeaderOffset(buffer.size()) {
+            m_Buffer.allocate(8);
+        }
+
+        ChecksummedFrameWriter(const ChecksummedFrameWriter &) = delete;
+
+        ChecksummedFrameWriter &operator=(const ChecksummedFrameWriter &) = delete;
+
+        ~ChecksummedFrameWriter() {
+            finish();
+        }
+
+        template<typename T>
+        ChecksummedFrameWriter &write(const T &value) {
+            m_Buffer.write(value);
+            return *this;
+        }
+
+        ChecksummedFrameWriter &pushBack(const auto &... values) {
+            (write(values), ...);
+            return *this;
+        }
+
+        void finish() {
+            if (m_Open) {
+                m_Open = false;
+                uint8_t *header = m_Buffer.getData().data() + m_HeaderOffset;
+                size_t size = m_Buffer.size() - m_HeaderOffset - 8;
+                if (size > UINT32_MAX) {
+                    throw IllegalArgumentException("DataBuffer checksummed frame larger than 4 GiB");
+                }
+                Impl::ToLittleEndian(static_cast<uint32_t>(size), header);
+                Impl::ToLittleEndian(Utils::Crc32c(header + 8, size, Utils::Crc32c(header, 4)), header + 4);
+            }
+        }
+    };
+
+    // Verifies the frame at source's read index and moves past it. The payload is returned as a buffer that reads it
+    // in place, so source has to outlive it. A truncated frame or a corrupt size throws ChecksumMismatchException as
+    // well, never BufferOverflowException.
+    inline DataBuffer ReadChecksummedFrame(DataBuffer &source) {
+        size_t available = source.size() - source.getReadIndex();
+        if (available < 8) {
+            throw ChecksumMismatchException("DataBuffer checksummed frame truncated in its header");
+        }
+        const uint8_t *header = source.data() + source.getReadIndex();
+        auto size = Impl::FromLittleEndian<uint32_t>(header);
+        auto expected = Impl::FromLittleEndian<uint32_t>(header + 4);
+        if (size > available - 8) {
+            throw ChecksumMismatchException("DataBuffer checksummed frame of " + std::to_string(size) +
+                                            " bytes does not fit in the " + std::to_string(available - 8) +
+                                            " bytes left, it is truncated or its header is corrupt");
+        }
+        auto actual = Utils::Crc32c(header + 8, size, Utils::Crc32c(header, 4));
+        if (actual != expected) {
+            throw ChecksumMismatchException("DataBuffer checksummed frame at read index " +
+                                            std::to_string(source.getReadIndex()) + " is corrupt");
+        }
+        source.consume(8 + size);
+        return DataBuffer(std::span<const uint8_t>(header + 8, size), nullptr, source.getEncoding());
+    }
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "DataBuffer.hpp"
+
+// LZ4 style block compression for DataBuffer content, no external dependency. A compressed stream is
+//     block* end
+//     block := rawSize:u32le storedSize:u32le payload    storedSize has its top bit set when the block is stored as is
+//     end   := 0:u32le
+// Blocks use the LZ4 block format (literal runs and (offset, length) back references into the last 64 KiB), so they
+// decompress at memory speed, and a block that would not shrink is stored uncompressed.
+namespace WayLib {
+    namespace Impl {
+        inline constexpr size_t Lz4MinMatch = 4;
+        // the last match has to start at least this far from the end and the last 5 bytes are always literals
+        inline constexpr size_t Lz4MatchStartLimit = 12;
+        inline constexpr size_t Lz4LastLiterals = 5;
+        inline constexpr size_t Lz4MaxOffset = 65535;
+        inline constexpr int Lz4HashLog = 12;
+
+        // every extra length byte adds at most 255 bytes of output, so no valid block decompresses to more than
+        // this many times its size (plus a few bytes for the smallest blocks)
+        inline constexpr size_t Lz4MaxExpansion = 255;
+
+        inline constexpr uint32_t StoredBlockFlag = 0x80000000u;
+
+        // worst case compressed size of size bytes
+        inline size_t Lz4CompressBound(size_t size) {
+            return size + size / 255 + 16;
+        }
+
+        inline uint32_t Lz4Read32(const uint8_t *in) {
+            uint32_t value;
+            std::memcpy(&value, in, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t Lz4Hash(uint32_t sequence) {
+            return (sequence * 2654435761u) >> (32 - Lz4HashLog);
+        }
+
+        inline uint8_t *Lz4WriteLength(uint8_t *out, size_t length) {
+            while (length >= 255) {
+                *out++ = 255;
+                length -= 255;
+            }
+            *out++ = static_cast<uint8_t>(length);
+            return out;
+        }
+
+        // literals [anchor, anchor + literals) followed by a match of matchLength at offset, matchLength 0 for the
+        // final literal run
+        inline uint8_t *Lz4WriteSequence(uint8_t *out, const uint8_t *anchor, size_t literals, size_t offset,
+                                         size_t matchLength) {
+            uint8_t *token = out++;
+            *token = static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4);
+            if (literals >= 15) {
+                out = Lz4WriteLength(out, literals - 15);
+            }
+            std::memcpy(out, anchor, literals);
+            out += literals;
+            if (matchLength) {
+                *out++ = static_cast<uint8_t>(offset);
+                *out++ = static_cast<uint8_t>(offset >> 8);
+                size_t length = matchLength - Lz4MinMatch;
+                *token |= static_cast<uint8_t>(std::min<size_t>(length, 15));
+                if (length >= 15) {
+                    out = Lz4WriteLength(out, length - 15);
+                }
+            }
+            return out;
+        }
+
+        // compresses size bytes into out, which needs room for Lz4CompressBound(size) bytes; returns the bytes written
+        inline size_t Lz4CompressBlock(const uint8_t *in, size_t size, uint8_t *out) {
+            const uint8_t *anchor = in;
+            uint8_t *op = out;
+            if (size >= Lz4MatchStartLimit + 1) {
+                // positions relative to in, a stale or zero entry is caught by comparing the bytes
+                std::array<uint32_t, size_t{1} << Lz4HashLog> table{};
+                const uint8_t *matchStartEnd = in + size - Lz4MatchStartLimit;
+                const uint8_t *matchEnd = in + size - Lz4LastLiterals;
+                const uint8_t *ip = in;
+                size_t misses = 0;
+                while (ip <= matchStartEnd) {
+                    uint32_t sequence = Lz4Read32(ip);
+                    uint32_t &slot = table[Lz4Hash(sequence)];
+                    const uint8_t *candidate = in + slot;
+                    slot = static_cast<uint32_t>(ip - in);
+                    if (candidate >= ip || static_cast<size_t>(ip - candidate) > Lz4MaxOffset
+                        || Lz4Read32(candidate) != sequence) {
+                        // step faster through data that does not compress
+                        ip += 1 + (misses++ >> 6);
+                        continue;
+                    }
+                    misses = 0;
+                    while (ip > anchor && candidate > in && ip[-1] == candidate[-1]) {
+                        --ip;
+                        --candidate;
+                    }
+                    size_t length = Lz4MinMatch;
+                    while (ip + length < matchEnd && ip[length] == candidate[length]) {
+                        ++length;
+                    }
+                    op = Lz4WriteSequence(op, anchor, static_cast<size_t>(ip - anchor),
+                                          static_cast<size_t>(ip - candidate), length);
+                    ip += length;
+                    anchor = ip;
+                    if (ip - 2 >= in) {
+                        table[Lz4Hash(Lz4Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - in);
+                    }
+                }
+            }
+            op = Lz4WriteSequence(op, anchor, static_cast<size_t>(in + size - anchor), 0, 0);
+            return static_cast<size_t>(op - out);
+        }
+
+        // false unless in is a well formed block that decompresses to exactly size bytes; never reads or writes
+        // outside the given ranges, whatever the input
+        inline bool Lz4DecompressBlock(const uint8_t *in, size_t inSize, uint8_t *out, size_t size) {
+            const uint8_t *ip = in;
+            const uint8_t *inEnd = in + inSize;
+            uint8_t *op = out;
+            uint8_t *outEnd = out + size;
+
+            auto readLength = [&](size_t &length) {
+                uint8_t byte;
+                do {
+                    if (ip == inEnd) {
+                        return false;
+                    }
+                    byte = *ip++;
+                    length += byte;
+                } while (byte == 255);
+                return true;
+            };
+
+            while (ip < inEnd) {
+                uint8_t token = *ip++;
+                size_t literals = token >> 4;
+                if (literals == 15 && !readLength(literals)) {
+                    return false;
+                }
+                if (literals > static_cast<size_t>(inEnd - ip) || literals > static_cast<size_t>(outEnd - op)) {
+                    return false;
+                }
+                std::memcpy(op, ip, literals);
+                op += literals;
+                ip += literals;
+                if (ip == inEnd) {
+                    break;
+                }
+
+                if (inEnd - ip < 2) {
+                    return false;
+                }
+                size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+                ip += 2;
+                size_t length = token & 15;
+                if (length == 15 && !readLength(length)) {
+                    return false;
+                }
+                length += Lz4MinMatch;
+                if (!offset || offset > static_cast<size_t>(op - out) || length > static_cast<size_t>(outEnd - op)) {
+                    return false;
+                }
+                const uint8_t *match = op - offset;
+                if (offset >= length) {
+                    std::memcpy(op, match, length);
+                    op += length;
+                } else {
+                    // overlapping copy repeats the last offset bytes
+                    for (size_t i = 0; i < length; ++i) {
+                        *op++ = match[i];
+                    }
+                }
+            }
+            return op == outEnd;
+        }
+
+        // appends one compressed block holding size bytes to target
+        inline void WriteCompressedBlock(DataBuffer &target, const uint8_t *data, size_t size) {
+            if (size >= StoredBlockFlag) {
+                throw IllegalArgumentException("DataBuffer compressed block larger than 2 GiB: " + std::to_string(size));
+            }
+            size_t start = target.size();
+            uint8_t *header = target.allocate(8 + Lz4CompressBound(size));
+            size_t stored = Lz4CompressBlock(data, size, header + 8);
+            uint32_t storedField = static_cast<uint32_t>(stored);
+            if (stored >= size) {
+                std::memcpy(header + 8, data, size);
+                stored = size;
+                storedField = static_cast<uint32_t>(size) | StoredBlockFlag;
+            }
+            ToLittleEndian(static_cast<uint32_t>(size), header);
+            ToLittleEndian(storedField, header + 4);
+            target.getData().resize(start + 8 + stored);
+        }
+
+        // reads the block at source's read index and replaces block's content with it, false at the end marker
+        inline bool ReadCompressedBlock(DataBuffer &source, DataBuffer &block) {
+            auto size = FromLittleEndian<uint32_t>(source.consume(4));
+            if (!size) {
+                return false;
+            }
+            auto storedField = FromLittleEndian<uint32_t>(source.consume(4));
+            size_t stored = storedField & ~StoredBlockFlag;
+            const uint8_t *payload = source.consume(stored);
+
+            // the header is untrusted, check it against the payload before allocating rawSize bytes
+            bool isStored = storedField & StoredBlockFlag;
+            if (isStored && stored != size) {
+                throw BufferOverflowException("DataBuffer stored block size does not match its content");
+            }
+            if (!isStored && (size >= StoredBlockFlag || size > Lz4MaxExpansion * stored + 16)) {
+                throw BufferOverflowException("DataBuffer compressed block claims more data than it can hold: " +
+                                              std::to_string(size) + " from " + std::to_string(stored) + " bytes");
+            }
+
+            block.clear();
+            uint8_t *out = block.allocate(size);
+            if (isStored) {
+                std::memcpy(out, payload, size);
+            } else if (!Lz4DecompressBlock(payload, stored, out, size)) {
+                throw BufferOverflowException("DataBuffer compressed block is corrupt");
+            }
+            return true;
+        }
+    }
+
+    // Serializes values into a block and compresses it into target whenever it reaches blockSize, so the
+    // uncompressed stream is never held in full. A value is never split across blocks, which is what lets
+    // DecompressingReader decompress one block at a time. The end marker is written by finish() or the destructor.
+    class CompressingWriter {
+        DataBuffer &m_Target;
+        DataBuffer m_Block;
+        size_t m_BlockSize;
+        bool m_Finished{};
+
+    public:
+        static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+        explicit CompressingWriter(DataBuffer &target, size_t blockSize = DefaultBlockSize)
+            : m_Target(target), m_Block(target.getEncoding()), m_BlockSize(blockSize ? blockSize : DefaultBlockSize) {
+            m_Block.reserve(m_BlockSize);
+        }
+
+        CompressingWriter(const CompressingWriter &) = delete;
+
+        CompressingWriter &operator=(const CompressingWriter &) = delete;
+
+        ~CompressingWriter() {
+            finish();
+        }
+
+        template<typename T>
+        CompressingWriter &write(const T &value) {
+            m_Block.write(value);
+            if (m_Block.size() >= m_BlockSize) {
+                flush();
+            }
+            return *this;
+        }
+
+        CompressingWriter &pushBack(const auto &... values) {
+            (write(values), ...);
+            return *this;
+        }
+
+        // compresses whatever is pending into a block of its own, e.g. before handing target to a socket
+        void flush() {
+            if (m_Block.size()) {
+                Impl::WriteCompressedBlock(m_Target, m_Block.data(), m_Block.size());
+                m_Block.clear();
+            }
+        }
+
+        void finish() {
+            if (!m_Finished) {
+                m_Finished = true;
+                flush();
+                Impl::ToLittleEndian(uint32_t{}, m_Target.allocate(4));
+            }
+        }
+    };
+
+    // Reads values from a stream written by CompressingWriter, decompressing the next block only once the previous
+    // one has been read to its end. Values have to be read in the same units they were written in.
+    class DecompressingReader {
+        DataBuffer &m_Source;
+        DataBuffer m_Block;
+        bool m_Ended{};
+
+    public:
+        explicit DecompressingReader(DataBuffer &source) : m_Source(source), m_Block(source.getEncoding()) {}
+
+        template<typename T>
+        DecompressingReader &read(T &ref) {
+            if (!nextBlock()) {
+                throw BufferOverflowException("DataBuffer read past the end of the compressed stream");
+            }
+            m_Block.read(ref);
+            return *this;
+        }
+
+        template<typename T>
+        T read() {
+            T value;
+            read(value);
+            return value;
+        }
+
+        DecompressingReader &popFront(auto &... args) {
+            (read(args), ...);
+            return *this;
+        }
+
+        // true once every value has been read; the source's read index is then right after the end marker
+        bool atEnd() {
+            return !nextBlock();
+        }
+
+    private:
+        // makes sure there is something left to read in the current block
+        bool nextBlock() {
+            while (m_Block.getReadIndex() == m_Block.size()) {
+                if (m_Ended || !Impl::ReadCompressedBlock(m_Source, m_Block)) {
+                    m_Ended = true;
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // compresses the whole content of buffer at once, blocks are cut every blockSize bytes regardless of values, so
+    // the result is read back with DecompressBuffer
+    inline DataBuffer CompressBuffer(const DataBuffer &buffer, size_t blockSize = CompressingWriter::DefaultBlockSize) {
+        DataBuffer result(buffer.getEncoding());
+        blockSize = blockSize ? blockSize : CompressingWriter::DefaultBlockSize;
+        result.reserve(Impl::Lz4CompressBound(buffer.size()) / 2 + 16);
+        for (size_t offset = 0; offset < buffer.size(); offset += blockSize) {
+            Impl::WriteCompressedBlock(result, buffer.data() + offset, std::min(blockSize, buffer.size() - offset));
+        }
+        Impl::ToLittleEndian(uint32_t{}, result.allocate(4));
+        return result;
+    }
+
+    // decompresses the stream at source's read index in full, works on the output of both CompressBuffer and
+    // CompressingWriter
+    inline DataBuffer DecompressBuffer(DataBuffer &source) {
+        DataBuffer result(source.getEncoding());
+        DataBuffer block(source.getEncoding());
+        while (Impl::ReadCompressedBlock(source, block)) {
+            result.simpleAppend(block.data(), block.size());
+        }
+        return result;
+    }
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "DataBuffer.hpp"
+#include "ThreadLocalCache.hpp"
+
+namespace WayLib {
+    // Recycles DataBuffer storage through thread local free lists, one per power of two size class from MinClassSize
+    // to MaxClassSize, so making and dropping a buffer per message does not go through the allocator once warm.
+    // A buffer may be released on any thread, it then joins that thread's free list.
+    class DataBufferPool {
+    public:
+        static constexpr size_t MinClassSize = 256;
+        static constexpr size_t ClassCount = 13;
+        static constexpr size_t MaxClassSize = MinClassSize << (ClassCount - 1);
+        static constexpr size_t MaxCachedPerClass = 32;
+
+        struct Statistics {
+            uint64_t m_Hits{};
+            uint64_t m_Misses{};
+            uint64_t m_Returned{};
+            uint64_t m_Dropped{};
+        };
+
+        // returns its buffer to the pool when it goes out of scope, unless it was detached
+        class PooledBuffer {
+            DataBuffer m_Buffer;
+            bool m_Owned{};
+
+        public:
+            PooledBuffer() = default;
+
+            explicit PooledBuffer(DataBuffer buffer) : m_Buffer(std::move(buffer)), m_Owned(true) {}
+
+            PooledBuffer(PooledBuffer &&rhs) noexcept : m_Buffer(std::move(rhs.m_Buffer)),
+                                                        m_Owned(std::exchange(rhs.m_Owned, false)) {}
+
+            PooledBuffer &operator=(PooledBuffer &&rhs) noexcept {
+                if (this != &rhs) {
+                    giveBack();
+                    m_Buffer = std::move(rhs.m_Buffer);
+                    m_Owned = std::exchange(rhs.m_Owned, false);
+                }
+                return *this;
+            }
+
+            PooledBuffer(const PooledBuffer &) = delete;
+
+            PooledBuffer &operator=(const PooledBuffer &) = delete;
+
+            ~PooledBuffer() {
+                giveBack();
+            }
+
+            DataBuffer &get() {
+                return m_Buffer;
+            }
+
+            DataBuffer &operator*() {
+                return m_Buffer;
+            }
+
+            DataBuffer *operator->() {
+                return &m_Buffer;
+            }
+
+            // keeps the buffer out of the pool, it can still be handed to Release later
+            DataBuffer detach() {
+                m_Owned = false;
+                return std::move(m_Buffer);
+            }
+
+        private:
+            void giveBack() {
+                if (m_Owned) {
+                    m_Owned = false;
+                    Release(std::move(m_Buffer));
+                }
+            }
+        };
+
+        // an empty buffer with room for at least capacity bytes
+        static DataBuffer Acquire(size_t capacity = MinClassSize) {
+            size_t sizeClass = AcquireClassOf(capacity);
+            if (sizeClass < ClassCount && LocalCache::Alive()) {
+                auto &cache = LocalCache::Get();
+                auto &freeList = cache.m_Free[sizeClass];
+                if (!freeList.empty()) {
+                    Increment(cache.m_Counters.m_Hits);
+                    DataBuffer buffer(std::move(freeList.back()));
+                    freeList.pop_back();
+                    return buffer;
+                }
+                Increment(cache.m_Counters.m_Misses);
+            }
+            DataBuffer::Storage storage;
+            storage.reserve(sizeClass < ClassCount ? MinClassSize << sizeClass : capacity);
+            return DataBuffer(std::move(storage));
+        }
+
+        static PooledBuffer AcquireScoped(size_t capacity = MinClassSize) {
+            return PooledBuffer(Acquire(capacity));
+        }
+
+        // buffers smaller than MinClassSize or bigger than MaxClassSize, and those that find their list full, are freed
+        static void Release(DataBuffer &&buffer) {
+            auto storage = buffer.releaseStorage();
+            size_t sizeClass = ReleaseClassOf(storage.capacity());
+            if (!LocalCache::Alive()) {
+                return;
+            }
+            auto &cache = LocalCache::Get();
+            if (sizeClass >= ClassCount || cache.m_Free[sizeClass].size() >= MaxCachedPerClass) {
+                Increment(cache.m_Counters.m_Dropped);
+                return;
+            }
+            storage.clear();
+            cache.m_Free[sizeClass].push_back(std::move(storage));
+            Increment(cache.m_Counters.m_Returned);
+        }
+
+        // totals over all threads, including threads that have exited
+        static Statistics GetStatistics() {
+            auto &registry = Impl::LeakedSingleton<Registry>();
+            std::scoped_lock lock(registry.m_Mutex);
+            Statistics result = registry.m_Retired;
+            for (auto *counters: registry.m_Live) {
+                counters->addTo(result);
+            }
+            return result;
+        }
+
+        // frees every buffer cached by the calling thread
+        static void Trim() {
+            if (LocalCache::Alive()) {
+                for (auto &freeList: LocalCache::Get().m_Free) {
+                    freeList.clear();
+                }
+            }
+        }
+
+    private:
+        // only ever written by the owning thread, atomic so GetStatistics can read them from another one
+        struct Counters {
+            std::atomic<uint64_t> m_Hits{};
+            std::atomic<uint64_t> m_Misses{};
+            std::atomic<uint64_t> m_Returned{};
+            std::atomic<uint64_t> m_Dropped{};
+
+            void addTo(Statistics &statistics) const {
+                statistics.m_Hits += m_Hits.load(std::memory_order_relaxed);
+                statistics.m_Misses += m_Misses.load(std::memory_order_relaxed);
+                statistics.m_Returned += m_Returned.load(std::memory_order_relaxed);
+                statistics.m_Dropped += m_Dropped.load(std::memory_order_relaxed);
+            }
+        };
+
+        struct Registry {
+            std::mutex m_Mutex;
+            std::vector<const Counters *> m_Live;
+            Statistics m_Retired;
+        };
+
+        struct Cache {
+            std::array<std::vector<DataBuffer::Storage>, ClassCount> m_Free;
+            Counters m_Counters;
+
+            Cache() {
+                for (auto &freeList: m_Free) {
+                    freeList.reserve(MaxCachedPerClass);
+                }
+                auto &registry = Impl::LeakedSingleton<Registry>();
+                std::scoped_lock lock(registry.m_Mutex);
+                registry.m_Live.push_back(&m_Counters);
+            }
+
+            ~Cache() {
+                auto &registry = Impl::LeakedSingleton<Registry>();
+                std::scoped_lock lock(registry.m_Mutex);
+                m_Counters.addTo(registry.m_Retired);
+                std::erase(registry.m_Live, &m_Counters);
+            }
+        };
+
+        static void Increment(std::atomic<uint64_t> &counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        using LocalCache = Impl::ThreadLocalCache<Cache>;
+
+        // smallest class whose buffers all hold at least capacity bytes
+        static size_t AcquireClassOf(size_t capacity) {
+            size_t sizeClass = 0;
+            while (sizeClass < ClassCount && (MinClassSize << sizeClass) < capacity) {
+                ++sizeClass;
+            }
+            return sizeClass;
+        }
+
+        // largest class whose size fits in capacity, ClassCount if there is none
+        static size_t ReleaseClassOf(size_t capacity) {
+            if (capacity < MinClassSize || capacity > MaxClassSize * 2 - 1) {
+                return ClassCount;
+            }
+            size_t sizeClass = 0;
+            while (sizeClass + 1 < ClassCount && (MinClassSize << (sizeClass + 1)) <= capacity) {
+                ++sizeClass;
+            }
+            return sizeClass;
+        }
+    };
+}
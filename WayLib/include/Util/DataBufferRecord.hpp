@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+
+#include "DataBuffer.hpp"
+
+// Tagged, length delimited records on top of DataBuffer:
+//     record := size:u32le version:u32 field*       size counts every byte after itself
+//     field  := id:u32 size:u32le payload           payload is the value's normal DataBuffer encoding
+// version and id follow the buffer's encoding (varints in Compact mode), the two sizes are always four little endian
+// bytes so they can be patched once the content is written. Any field or whole record can be stepped over in O(1),
+// which lets readers ignore fields they do not know or do not need.
+namespace WayLib {
+    namespace Impl {
+        inline void StoreRecordSize(uint8_t *out, size_t size) {
+            if (size > std::numeric_limits<uint32_t>::max()) {
+                throw IllegalArgumentException("DataBuffer record or field larger than 4 GiB: " + std::to_string(size));
+            }
+            for (int i = 0; i < 4; ++i) {
+                out[i] = static_cast<uint8_t>(size >> (8 * i));
+            }
+        }
+
+        inline size_t LoadRecordSize(const uint8_t *in) {
+            return static_cast<size_t>(in[0]) | static_cast<size_t>(in[1]) << 8 | static_cast<size_t>(in[2]) << 16
+                   | static_cast<size_t>(in[3]) << 24;
+        }
+
+        constexpr size_t RecordSizeBytes = 4;
+    }
+
+    // Appends one record to buffer. The record is closed by finish() or when the writer goes out of scope.
+    class RecordWriter {
+        DataBuffer &m_Buffer;
+        size_t m_SizeOffset;
+        bool m_Open{true};
+
+    public:
+        explicit RecordWriter(DataBuffer &buffer, uint32_t version = 0)
+            : m_Buffer(buffer), m_SizeOffset(buffer.size()) {
+            m_Buffer.allocate(Impl::RecordSizeBytes);
+            m_Buffer.write(version);
+        }
+
+        RecordWriter(const RecordWriter &) = delete;
+
+        RecordWriter &operator=(const RecordWriter &) = delete;
+
+        ~RecordWriter() {
+            if (m_Open) {
+                patch(m_SizeOffset);
+            }
+        }
+
+        template<typename T>
+        RecordWriter &field(uint32_t id, const T &value) {
+            m_Buffer.write(id);
+            size_t sizeOffset = m_Buffer.size();
+            m_Buffer.allocate(Impl::RecordSizeBytes);
+            m_Buffer.write(value);
+            patch(sizeOffset);
+            // checked per field, so the destructor never has to throw
+            if (m_Buffer.size() - m_SizeOffset - Impl::RecordSizeBytes > std::numeric_limits<uint32_t>::max()) {
+                throw IllegalArgumentException("DataBuffer record larger than 4 GiB");
+            }
+            return *this;
+        }
+
+        void finish() {
+            if (m_Open) {
+                m_Open = false;
+                patch(m_SizeOffset);
+            }
+        }
+
+    private:
+        void patch(size_t sizeOffset) {
+            Impl::StoreRecordSize(m_Buffer.getData().data() + sizeOffset,
+                                  m_Buffer.size() - sizeOffset - Impl::RecordSizeBytes);
+        }
+    };
+
+    // Walks the fields of the record at the buffer's read index. Fields that are not read are skipped without being
+    // decoded; the read index ends up right after the record once the reader is finished or destroyed.
+    class RecordReader {
+        DataBuffer &m_Buffer;
+        size_t m_End;
+        uint32_t m_Version{};
+        std::optional<uint32_t> m_FieldId{};
+        size_t m_FieldEnd{};
+        bool m_Open{true};
+
+    public:
+        explicit RecordReader(DataBuffer &buffer) : m_Buffer(buffer) {
+            size_t size = Impl::LoadRecordSize(m_Buffer.consume(Impl::RecordSizeBytes));
+            m_Buffer.checkSize(size);
+            m_End = m_Buffer.getReadIndex() + size;
+            m_Version = m_Buffer.read<uint32_t>();
+            m_FieldEnd = m_Buffer.getReadIndex();
+            checkInside(m_FieldEnd, m_End);
+        }
+
+        RecordReader(const RecordReader &) = delete;
+
+        RecordReader &operator=(const RecordReader &) = delete;
+
+        ~RecordReader() {
+            if (m_Open) {
+                m_Buffer.getReadIndex() = m_End;
+            }
+        }
+
+        [[nodiscard]] uint32_t getVersion() const {
+            return m_Version;
+        }
+
+        // moves to the next field, skipping whatever is left of the current one; false at the end of the record
+        bool next() {
+            m_Buffer.getReadIndex() = m_FieldEnd;
+            if (m_FieldEnd >= m_End) {
+                m_FieldId.reset();
+                return false;
+            }
+            m_FieldId = m_Buffer.read<uint32_t>();
+            size_t size = Impl::LoadRecordSize(m_Buffer.consume(Impl::RecordSizeBytes));
+            checkInside(m_Buffer.getReadIndex(), m_End);
+            if (size > m_End - m_Buffer.getReadIndex()) {
+                throw BufferOverflowException("DataBuffer record field of " + std::to_string(size) +
+                                              " bytes runs past the end of its record");
+            }
+            m_FieldEnd = m_Buffer.getReadIndex() + size;
+            return true;
+        }
+
+        [[nodiscard]] uint32_t fieldId() const {
+            return *m_FieldId;
+        }
+
+        [[nodiscard]] size_t fieldSize() const {
+            return m_FieldEnd - m_Buffer.getReadIndex();
+        }
+
+        // decodes the current field, which must not read past the field's end
+        template<typename T>
+        T read() {
+            T value = m_Buffer.read<T>();
+            checkInside(m_Buffer.getReadIndex(), m_FieldEnd);
+            return value;
+        }
+
+        template<typename T>
+        RecordReader &read(T &ref) {
+            ref = read<T>();
+            return *this;
+        }
+
+        // decodes the first field with the given id, skipping every field before it
+        template<typename T>
+        std::optional<T> find(uint32_t id) {
+            while (next()) {
+                if (*m_FieldId == id) {
+                    return read<T>();
+                }
+            }
+            return std::nullopt;
+        }
+
+        // moves the read index right after the record
+        void finish() {
+            if (m_Open) {
+                m_Open = false;
+                m_Buffer.getReadIndex() = m_End;
+            }
+        }
+
+        // steps over a whole record without looking inside it
+        static void SkipRecord(DataBuffer &buffer) {
+            size_t size = Impl::LoadRecordSize(buffer.consume(Impl::RecordSizeBytes));
+            buffer.consume(size);
+        }
+
+    private:
+        void checkInside(size_t index, size_t end) const {
+            if (index > end) {
+                throw BufferOverflowException("DataBuffer record read past the end of its " +
+                                              std::string(end == m_End ? "record" : "field"));
+            }
+        }
+    };
+}
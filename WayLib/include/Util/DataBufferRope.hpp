@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "DataBuffer.hpp"
+#include "Exceptions.hpp"
+#include "MappedFile.hpp"
+
+namespace WayLib {
+    // A DataBuffer split into segments. Small values are serialized into an owned tail chunk as usual, large payloads
+    // can be added by reference and are never copied, and flushTo hands every segment to the kernel in one writev.
+    // The bytes produced are exactly what a single DataBuffer would hold after the same writes.
+    class DataBufferRope {
+        struct Segment {
+            const uint8_t *m_Data;
+            size_t m_Size;
+            // keeps the bytes alive, empty for references the caller guarantees to outlive the rope
+            std::shared_ptr<const void> m_Owner;
+        };
+
+        std::vector<Segment> m_Segments;
+        size_t m_SealedSize{};
+        DataBuffer m_Tail;
+        size_t m_ReferenceThreshold;
+
+    public:
+        static constexpr size_t DefaultReferenceThreshold = 4096;
+
+        explicit DataBufferRope(DataBufferEncoding encoding = DefaultDataBufferEncoding,
+                                size_t referenceThreshold = DefaultReferenceThreshold)
+            : m_Tail(encoding), m_ReferenceThreshold(referenceThreshold) {}
+
+        [[nodiscard]] size_t size() const {
+            return m_SealedSize + m_Tail.size();
+        }
+
+        [[nodiscard]] size_t segmentCount() const {
+            return m_Segments.size() + (m_Tail.size() ? 1 : 0);
+        }
+
+        [[nodiscard]] DataBufferEncoding getEncoding() const {
+            return m_Tail.getEncoding();
+        }
+
+        // serialized into the owned tail, like DataBuffer::write
+        template<typename T>
+        DataBufferRope &write(const T &value) {
+            m_Tail.write(value);
+            return *this;
+        }
+
+        DataBufferRope &pushBack(const auto &... values) {
+            (write(values), ...);
+            return *this;
+        }
+
+        DataBufferRope &appendBytes(const void *data, size_t size) {
+            m_Tail.simpleAppend(data, size);
+            return *this;
+        }
+
+        // adds size bytes without copying them; without an owner they have to stay valid until the rope is flushed
+        DataBufferRope &appendReference(const void *data, size_t size, std::shared_ptr<const void> owner = {}) {
+            if (size) {
+                seal();
+                m_Segments.push_back({static_cast<const uint8_t *>(data), size, std::move(owner)});
+                m_SealedSize += size;
+            }
+            return *this;
+        }
+
+        // takes over a whole buffer's bytes as one segment
+        DataBufferRope &appendBuffer(DataBuffer &&buffer) {
+            if (buffer.size()) {
+                auto owner = std::make_shared<DataBuffer>(std::move(buffer));
+                appendReference(owner->data(), owner->size(), owner);
+            }
+            return *this;
+        }
+
+        // Same bytes as write(value) for std::string and vectors of bulk serializable elements, but payloads of at
+        // least the reference threshold are referenced instead of copied. value has to outlive the flush.
+        template<typename T>
+        DataBufferRope &writeReferenced(const T &value) {
+            using Element = typename T::value_type;
+            static_assert(IsBulkSerializableV<Element>, "writeReferenced needs contiguous, bulk serializable elements");
+            size_t bytes = value.size() * sizeof(Element);
+            if (bytes < m_ReferenceThreshold || !m_Tail.canCopyRaw<Element>()) {
+                return write(value);
+            }
+            m_Tail.write(value.size());
+            return appendReference(value.data(), bytes);
+        }
+
+        // writes every segment to fd, one writev call unless there are more than IOV_MAX segments or the kernel
+        // takes less than everything; the rope is empty afterwards
+        size_t flushTo(int fd) {
+            seal();
+            size_t total = 0;
+#ifdef _WIN32
+            for (auto &segment: m_Segments) {
+                size_t written = 0;
+                while (written < segment.m_Size) {
+                    auto chunk = static_cast<unsigned>(std::min<size_t>(segment.m_Size - written, INT_MAX));
+                    int result = ::_write(fd, segment.m_Data + written, chunk);
+                    if (result < 0) {
+                        throw FileIOException("DataBufferRope::flushTo: write failed, errno " + std::to_string(errno));
+                    }
+                    written += static_cast<size_t>(result);
+                }
+                total += written;
+            }
+#else
+            std::vector<iovec> vectors;
+            vectors.reserve(m_Segments.size());
+            for (auto &segment: m_Segments) {
+                vectors.push_back({const_cast<uint8_t *>(segment.m_Data), segment.m_Size});
+            }
+            size_t index = 0;
+            while (index < vectors.size()) {
+                int count = static_cast<int>(std::min<size_t>(vectors.size() - index, IOV_MAX));
+                ssize_t result = ::writev(fd, vectors.data() + index, count);
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw FileIOException("DataBufferRope::flushTo: writev failed, errno " + std::to_string(errno));
+                }
+                total += static_cast<size_t>(result);
+                // skip what was fully written and trim a partially written segment
+                auto remaining = static_cast<size_t>(result);
+                while (index < vectors.size() && remaining >= vectors[index].iov_len) {
+                    remaining -= vectors[index++].iov_len;
+                }
+                if (remaining) {
+                    vectors[index].iov_base = static_cast<uint8_t *>(vectors[index].iov_base) + remaining;
+                    vectors[index].iov_len -= remaining;
+                }
+            }
+#endif
+            clear();
+            return total;
+        }
+
+        void writeToStream(std::ostream &os) const {
+            for (auto &segment: m_Segments) {
+                os.write(reinterpret_cast<const char *>(segment.m_Data), static_cast<std::streamsize>(segment.m_Size));
+            }
+            os.write(reinterpret_cast<const char *>(m_Tail.data()), static_cast<std::streamsize>(m_Tail.size()));
+        }
+
+        // copies everything into one contiguous buffer
+        DataBuffer flatten() const {
+            DataBuffer result(getEncoding());
+            result.reserve(size());
+            for (auto &segment: m_Segments) {
+                result.simpleAppend(segment.m_Data, segment.m_Size);
+            }
+            result.simpleAppend(m_Tail.data(), m_Tail.size());
+            return result;
+        }
+
+        void clear() {
+            m_Segments.clear();
+            m_SealedSize = 0;
+            m_Tail.clear();
+        }
+
+    private:
+        // the tail becomes a segment of its own and a fresh tail takes the following writes
+        void seal() {
+            if (m_Tail.size()) {
+                auto encoding = m_Tail.getEncoding();
+                auto owner = std::make_shared<DataBuffer>(std::move(m_Tail));
+                m_Segments.push_back({owner->data(), owner->size(), owner});
+                m_SealedSize += owner->size();
+                m_Tail = DataBuffer(encoding);
+            }
+        }
+    };
+
+    // Reads everything left in fd straight into buffer storage. Regular files are sized with fstat and read with
+    // pread into a single allocation, anything else (pipes, sockets) is read in chunks until end of file.
+    inline DataBuffer CreateBufferFromFd(int fd, DataBufferEncoding encoding = DefaultDataBufferEncoding) {
+        constexpr size_t ChunkSize = 64 * 1024;
+
+        DataBuffer buffer(encoding);
+        auto &data = buffer.getData();
+#ifdef _WIN32
+        while (true) {
+            size_t size = data.size();
+            data.resize(size + ChunkSize);
+            int result = ::_read(fd, data.data() + size, static_cast<unsigned>(ChunkSize));
+            if (result < 0) {
+                throw FileIOException("CreateBufferFromFd: read failed, errno " + std::to_string(errno));
+            }
+            data.resize(size + static_cast<size_t>(result));
+            if (!result) {
+                break;
+            }
+        }
+#else
+        struct stat status{};
+        off_t offset = -1;
+        if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+            offset = ::lseek(fd, 0, SEEK_CUR);
+        }
+        if (offset >= 0) {
+            size_t size = status.st_size > offset ? static_cast<size_t>(status.st_size - offset) : 0;
+            data.resize(size);
+            size_t done = 0;
+            while (done < size) {
+                ssize_t result = ::pread(fd, data.data() + done, size - done, offset + static_cast<off_t>(done));
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw FileIOException("CreateBufferFromFd: pread failed, errno " + std::to_string(errno));
+                }
+                if (!result) {
+                    // the file shrank while it was being read
+                    break;
+                }
+                done += static_cast<size_t>(result);
+            }
+            data.resize(done);
+            ::lseek(fd, offset + static_cast<off_t>(done), SEEK_SET);
+        } else {
+            while (true) {
+                size_t size = data.size();
+                data.resize(size + ChunkSize);
+                ssize_t result = ::read(fd, data.data() + size, ChunkSize);
+                if (result < 0 && errno == EINTR) {
+                    data.resize(size);
+                    continue;
+                }
+                if (result < 0) {
+                    throw FileIOException("CreateBufferFromFd: read failed, errno " + std::to_string(errno));
+                }
+                data.resize(size + static_cast<size_t>(result));
+                if (!result) {
+                    break;
+                }
+            }
+        }
+#endif
+        return buffer;
+    }
+
+    // Deserializes straight from a read-only mapping of the file: pages are read in by the OS as the read index
+    // reaches them, so opening a multi-GB snapshot costs neither the upfront copy nor twice its size in memory.
+    // The mapping is released with the last buffer (or copy) referring to it.
+    inline DataBuffer CreateBufferFromMappedFile(const std::string &path,
+                                                 DataBufferEncoding encoding = DefaultDataBufferEncoding) {
+        auto file = std::make_shared<Utils::MappedFile>(path);
+        file->adviseSequential();
+        std::span<const uint8_t> bytes(file->data(), file->size());
+        return DataBuffer(bytes, std::move(file), encoding);
+    }
+
+    inline DataBuffer CreateBufferFromFile(const std::string &path,
+                                           DataBufferEncoding encoding = DefaultDataBufferEncoding) {
+#ifdef _WIN32
+        int fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+        if (fd < 0) {
+            throw FileIOException("Failed to open file: " + path);
+        }
+        struct Closer {
+            int m_Fd;
+
+            ~Closer() {
+#ifdef _WIN32
+                ::_close(m_Fd);
+#else
+                ::close(m_Fd);
+#endif
+            }
+        } closer{fd};
+        return CreateBufferFromFd(fd, encoding);
+    }
+}
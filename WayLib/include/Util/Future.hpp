@@ -0,0 +1,274 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "ThreadLocalCache.hpp"
+
+namespace WayLib {
+    template<typename T>
+    class Future;
+
+    template<typename T>
+    class Promise;
+
+    namespace Impl {
+        struct VoidValue {};
+
+        // Shared state between one Promise and one Future. States are recycled through a thread local free list,
+        // the mutex and condition variable are constructed once and reused, so a warm pool never allocates.
+        template<typename T>
+        class FutureState {
+            using ValueType = std::conditional_t<std::is_void_v<T>, VoidValue, T>;
+
+            std::mutex m_Mutex{};
+            std::condition_variable m_Condition{};
+            std::atomic<bool> m_Ready{false};
+            std::optional<ValueType> m_Value{};
+            std::exception_ptr m_Exception{};
+            uint32_t m_References{2};
+            FutureState *m_NextFree{};
+
+            friend class Future<T>;
+            friend class Promise<T>;
+
+            static constexpr size_t PoolCapacity = 1024;
+
+            struct Pool {
+                FutureState *m_Free{};
+                size_t m_Count{};
+
+                ~Pool() {
+                    while (m_Free) {
+                        delete std::exchange(m_Free, m_Free->m_NextFree);
+                    }
+                }
+            };
+
+            using LocalPool = ThreadLocalCache<Pool>;
+
+            void recycle() {
+                m_Value.reset();
+                m_Exception = nullptr;
+                m_Ready.store(false, std::memory_order_relaxed);
+                m_References = 2;
+
+                if (!LocalPool::Alive() || LocalPool::Get().m_Count >= PoolCapacity) {
+                    delete this;
+                    return;
+                }
+                auto &pool = LocalPool::Get();
+                m_NextFree = pool.m_Free;
+                pool.m_Free = this;
+                ++pool.m_Count;
+            }
+
+        public:
+            static FutureState *Acquire() {
+                if (LocalPool::Alive()) {
+                    auto &pool = LocalPool::Get();
+                    if (pool.m_Free) {
+                        --pool.m_Count;
+                        return std::exchange(pool.m_Free, pool.m_Free->m_NextFree);
+                    }
+                }
+                return new FutureState;
+            }
+
+            // the reference count is only touched under the lock, so whoever drops the last reference knows that the
+            // other side has already left its critical section and will not touch this state again
+            void release() {
+                bool last; {
+                    std::scoped_lock lock(m_Mutex);
+                    last = --m_References == 0;
+                }
+                if (last) {
+                    recycle();
+                }
+            }
+
+            // The promise gives up its reference before the future can observe the result, so in the common case the
+            // consumer drops the last reference and the state goes back to the pool of the thread that took it out.
+            template<typename Setter>
+            void complete(Setter &&setter) {
+                bool last; {
+                    std::scoped_lock lock(m_Mutex);
+                    setter();
+                    last = --m_References == 0;
+                    m_Ready.store(true, std::memory_order_release);
+                    m_Condition.notify_all();
+                }
+                if (last) {
+                    recycle();
+                }
+            }
+
+            bool isReady() const {
+                return m_Ready.load(std::memory_order_acquire);
+            }
+
+            void wait() {
+                std::unique_lock lock(m_Mutex);
+                m_Condition.wait(lock, [this] { return isReady(); });
+            }
+
+            template<typename Rep, typename Period>
+            bool waitFor(const std::chrono::duration<Rep, Period> &duration) {
+                std::unique_lock lock(m_Mutex);
+                return m_Condition.wait_for(lock, duration, [this] { return isReady(); });
+            }
+        };
+    }
+
+    // Drop-in for the parts of std::future that WayLib uses, backed by a pooled Impl::FutureState.
+    template<typename T>
+    class Future {
+        Impl::FutureState<T> *m_State{};
+
+        friend class Promise<T>;
+
+        explicit Future(Impl::FutureState<T> *state) : m_State(state) {}
+
+    public:
+        Future() = default;
+
+        Future(Future &&rhs) noexcept : m_State(std::exchange(rhs.m_State, nullptr)) {}
+
+        Future &operator=(Future &&rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                m_State = std::exchange(rhs.m_State, nullptr);
+            }
+            return *this;
+        }
+
+        Future(const Future &) = delete;
+
+        Future &operator=(const Future &) = delete;
+
+        ~Future() {
+            reset();
+        }
+
+        [[nodiscard]] bool valid() const {
+            return m_State;
+        }
+
+        [[nodiscard]] bool isReady() const {
+            return m_State && m_State->isReady();
+        }
+
+        void wait() const {
+            m_State->wait();
+        }
+
+        template<typename Rep, typename Period>
+        bool waitFor(const std::chrono::duration<Rep, Period> &duration) const {
+            return m_State->waitFor(duration);
+        }
+
+        // like std::future::get, the future is no longer valid afterwards
+        T get() {
+            if (!m_State) {
+                throw std::future_error(std::future_errc::no_state);
+            }
+            m_State->wait();
+            auto *state = std::exchange(m_State, nullptr);
+            if (state->m_Exception) {
+                auto exception = state->m_Exception;
+                state->release();
+                std::rethrow_exception(exception);
+            }
+            if constexpr (std::is_void_v<T>) {
+                state->release();
+            } else {
+                T result = std::move(*state->m_Value);
+                state->release();
+                return result;
+            }
+        }
+
+    private:
+        void reset() {
+            if (m_State) {
+                std::exchange(m_State, nullptr)->release();
+            }
+        }
+    };
+
+    template<typename T>
+    class Promise {
+        Impl::FutureState<T> *m_State{};
+
+    public:
+        Promise() = default;
+
+        Promise(Promise &&rhs) noexcept : m_State(std::exchange(rhs.m_State, nullptr)) {}
+
+        Promise &operator=(Promise &&rhs) noexcept {
+            if (this != &rhs) {
+                abandon();
+                m_State = std::exchange(rhs.m_State, nullptr);
+            }
+            return *this;
+        }
+
+        Promise(const Promise &) = delete;
+
+        Promise &operator=(const Promise &) = delete;
+
+        ~Promise() {
+            abandon();
+        }
+
+        static std::pair<Promise, Future<T> > Create() {
+            auto *state = Impl::FutureState<T>::Acquire();
+            Promise promise;
+            promise.m_State = state;
+            return {std::move(promise), Future<T>(state)};
+        }
+
+        template<typename... Args>
+        void setValue(Args &&... args) {
+            m_State->complete([&] {
+                m_State->m_Value.emplace(std::forward<Args>(args)...);
+            });
+            m_State = nullptr;
+        }
+
+        void setException(std::exception_ptr exception) {
+            m_State->complete([&] {
+                m_State->m_Exception = std::move(exception);
+            });
+            m_State = nullptr;
+        }
+
+        // runs function and stores either its result or the exception it threw
+        template<typename F>
+        void setResultOf(F &&function) {
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    std::forward<F>(function)();
+                    setValue();
+                } else {
+                    setValue(std::forward<F>(function)());
+                }
+            } catch (...) {
+                setException(std::current_exception());
+            }
+        }
+
+    private:
+        // a promise dropped without a result (e.g. its task was discarded by a stopped pool) breaks the future
+        void abandon() {
+            if (m_State) {
+                setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+        }
+    };
+}
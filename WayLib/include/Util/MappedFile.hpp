@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Util/Exceptions.hpp"
+
+namespace WayLib::Utils {
+    // Read-only mapping of a whole file. Nothing is read up front, pages are faulted in by the OS when touched,
+    // so opening a multi-GB file is cheap and resident memory follows what is actually being read.
+    class MappedFile {
+        const uint8_t *m_Data{};
+        size_t m_Size{};
+
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw FileIOException("Failed to open file for mapping: " + path);
+            }
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file, &size)) {
+                CloseHandle(file);
+                throw FileIOException("Failed to query file size: " + path);
+            }
+            m_Size = static_cast<size_t>(size.QuadPart);
+            if (m_Size) {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                // the view keeps the mapping and the file alive on its own
+                if (mapping) {
+                    CloseHandle(mapping);
+                }
+                CloseHandle(file);
+                if (!view) {
+                    throw FileIOException("Failed to map file: " + path);
+                }
+                m_Data = static_cast<const uint8_t *>(view);
+            } else {
+                CloseHandle(file);
+            }
+#else
+            int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (descriptor < 0) {
+                throw FileIOException("Failed to open file for mapping: " + path);
+            }
+            struct stat status{};
+            if (::fstat(descriptor, &status) != 0) {
+                ::close(descriptor);
+                throw FileIOException("Failed to query file size: " + path);
+            }
+            m_Size = static_cast<size_t>(status.st_size);
+            if (m_Size) {
+                void *view = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                // the mapping stays valid after the descriptor is closed
+                ::close(descriptor);
+                if (view == MAP_FAILED) {
+                    throw FileIOException("Failed to map file: " + path);
+                }
+                m_Data = static_cast<const uint8_t *>(view);
+            } else {
+                ::close(descriptor);
+            }
+#endif
+        }
+
+        MappedFile(MappedFile &&rhs) noexcept : m_Data(std::exchange(rhs.m_Data, nullptr)),
+                                                m_Size(std::exchange(rhs.m_Size, 0)) {}
+
+        MappedFile &operator=(MappedFile &&rhs) noexcept {
+            if (this != &rhs) {
+                unmap();
+                m_Data = std::exchange(rhs.m_Data, nullptr);
+                m_Size = std::exchange(rhs.m_Size, 0);
+            }
+            return *this;
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+            unmap();
+        }
+
+        [[nodiscard]] const uint8_t *data() const {
+            return m_Data;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return m_Size;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return !m_Size;
+        }
+
+        // tells the OS the file will be read front to back, so it reads ahead aggressively and drops pages early
+        void adviseSequential() const {
+#ifndef _WIN32
+            if (m_Data) {
+                ::madvise(const_cast<uint8_t *>(m_Data), m_Size, MADV_SEQUENTIAL);
+            }
+#endif
+        }
+
+        // drops the resident pages fully inside [offset, offset + length), they are read back from the file if touched
+        // again, so pointers into the range stay valid
+        void releasePages(size_t offset, size_t length) const {
+#ifndef _WIN32
+            static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+            size_t end = std::min(offset + length, m_Size) / pageSize * pageSize;
+            if (m_Data && begin < end) {
+                ::madvise(const_cast<uint8_t *>(m_Data) + begin, end - begin, MADV_DONTNEED);
+            }
+#endif
+        }
+
+    private:
+        void unmap() {
+            if (m_Data) {
+#ifdef _WIN32
+                UnmapViewOfFile(m_Data);
+#else
+                ::munmap(const_cast<uint8_t *>(m_Data), m_Size);
+#endif
+                m_Data = nullptr;
+                m_Size = 0;
+            }
+        }
+    };
+}
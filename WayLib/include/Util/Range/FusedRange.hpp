@@ -0,0 +1,169 @@
+#pragma once
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "Range.hpp"
+
+namespace WayLib {
+    namespace Ranges {
+        // element-wise stages (map / filter / forEach) mark themselves with IsFusible and provide
+        // Output<In> and push(item, next), which is all a FusedRange needs to run them in one loop
+        template<typename T, typename = void>
+        struct IsFusibleStage : std::false_type {};
+
+        template<typename T>
+        struct IsFusibleStage<T, std::enable_if_t<T::IsFusible> > : std::true_type {};
+
+        template<typename T>
+        inline constexpr bool IsFusibleStageV = IsFusibleStage<T>::value;
+
+        namespace Impl {
+            template<typename In, typename... Stages>
+            struct FusedOutput {
+                using type = In;
+            };
+
+            template<typename In, typename First, typename... Rest>
+            struct FusedOutput<In, First, Rest...> {
+                using type = typename FusedOutput<typename First::template Output<In>, Rest...>::type;
+            };
+        }
+    }
+
+    // A Range whose trailing element-wise stages are kept as a compile time chain instead of one std::function and
+    // one std::vector per stage. get() makes a single pass over the source and pushes every element through all
+    // stages, so only the final vector is ever allocated.
+    template<typename Source, typename... Stages>
+    class FusedRange {
+        using SourceValueType = typename Source::value_type;
+
+        Source m_Source;
+        std::tuple<Stages...> m_Stages;
+
+    public:
+        using value_type = typename Ranges::Impl::FusedOutput<SourceValueType, Stages...>::type;
+        using source_type = Source;
+
+    private:
+        mutable std::shared_ptr<std::vector<value_type> > m_Cache;
+
+        template<size_t I, typename Item, typename Sink>
+        void push(Item &&item, Sink &sink) const {
+            if constexpr (I == sizeof...(Stages)) {
+                sink(std::forward<Item>(item));
+            } else {
+                std::get<I>(m_Stages).push(std::forward<Item>(item), [this, &sink](auto &&next) {
+                    this->template push<I + 1>(std::forward<decltype(next)>(next), sink);
+                });
+            }
+        }
+
+    public:
+        explicit FusedRange(Source source, std::tuple<Stages...> stages = {})
+            : m_Source(std::move(source)), m_Stages(std::move(stages)) {}
+
+        const std::shared_ptr<std::vector<value_type> > &get() const {
+            if (!m_Cache) {
+                m_Cache = evaluate();
+            }
+            return m_Cache;
+        }
+
+        const std::shared_ptr<std::vector<value_type> > &getNoCache() const {
+            return m_Cache = evaluate();
+        }
+
+        // appends one more element-wise stage to the chain, nothing is evaluated
+        template<typename Stage>
+        auto fuse(Stage &&stage) const & {
+            return FusedRange<Source, Stages..., std::decay_t<Stage> >(
+                m_Source, std::tuple_cat(m_Stages, std::make_tuple(std::forward<Stage>(stage))));
+        }
+
+        template<typename Stage>
+        auto fuse(Stage &&stage) && {
+            return FusedRange<Source, Stages..., std::decay_t<Stage> >(
+                std::move(m_Source), std::tuple_cat(std::move(m_Stages), std::make_tuple(std::forward<Stage>(stage))));
+        }
+
+        const Source &getSource() const {
+            return m_Source;
+        }
+
+        auto begin() const {
+            return get()->begin();
+        }
+
+        auto end() const {
+            return get()->end();
+        }
+
+        auto size() const {
+            return get()->size();
+        }
+
+    private:
+        std::shared_ptr<std::vector<value_type> > evaluate() const {
+            auto &&source = m_Source.get();
+            if constexpr (sizeof...(Stages) == 0) {
+                return source;
+            } else {
+                auto result = std::make_shared<std::vector<value_type> >();
+                if constexpr ((Stages::KeepsSize && ...)) {
+                    result->reserve(source->size());
+                }
+                auto sink = [&result](auto &&item) {
+                    result->push_back(std::forward<decltype(item)>(item));
+                };
+                for (auto &item: *source) {
+                    push<0>(item, sink);
+                }
+                return result;
+            }
+        }
+    };
+
+    namespace Ranges {
+        template<typename T>
+        struct IsFusedRange : std::false_type {};
+
+        template<typename Source, typename... Stages>
+        struct IsFusedRange<FusedRange<Source, Stages...> > : std::true_type {};
+
+        template<typename T>
+        inline constexpr bool IsFusedRangeV = IsFusedRange<T>::value;
+
+        // switches the rest of the pipeline to fused evaluation: map / filter / forEach that follow are merged into
+        // one loop, any other stage evaluates the fused part once and continues as a normal Range on top of it
+        inline auto fused() {
+            return [](auto &&range) {
+                using RangeType = std::decay_t<decltype(range)>;
+                if constexpr (IsFusedRangeV<RangeType>) {
+                    return std::forward<decltype(range)>(range);
+                } else {
+                    return FusedRange<RangeType>(std::forward<decltype(range)>(range));
+                }
+            };
+        }
+    }
+}
+
+template<typename Source, typename... Stages, typename Convertor>
+decltype(auto) operator|(WayLib::FusedRange<Source, Stages...> &&range, Convertor &&converter) {
+    if constexpr (WayLib::Ranges::IsFusibleStageV<std::decay_t<Convertor> >) {
+        return std::move(range).fuse(std::forward<Convertor>(converter));
+    } else {
+        return WayLib::Ranges::autoSync()(converter(std::move(range)));
+    }
+}
+
+template<typename Source, typename... Stages, typename Convertor>
+decltype(auto) operator|(const WayLib::FusedRange<Source, Stages...> &range, Convertor &&converter) {
+    if constexpr (WayLib::Ranges::IsFusibleStageV<std::decay_t<Convertor> >) {
+        return range.fuse(std::forward<Convertor>(converter));
+    } else {
+        return WayLib::Ranges::autoSync()(converter(range));
+    }
+}
@@ -0,0 +1,335 @@
+#pragma once
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "Range.hpp"
+#include "FusedRange.hpp"
+
+namespace WayLib {
+    // A pull based, single pass Range. Every stage is a generator whose next() asks the stage before it for one element
+    // at a time, so a consumer that stops early (firstMatch, take, takeWhile) stops all upstream work as well.
+    // Generator requirements: a value_type and std::optional<value_type> next().
+    // get() drains whatever is left into a vector, which makes a LazyRange usable as the parent of any other stage.
+    template<typename Generator>
+    class LazyRange {
+    public:
+        using value_type = typename Generator::value_type;
+        using generator_type = Generator;
+
+    private:
+        mutable Generator m_Generator;
+        mutable std::shared_ptr<std::vector<value_type> > m_Cache;
+
+    public:
+        explicit LazyRange(Generator generator) : m_Generator(std::move(generator)) {}
+
+        std::optional<value_type> next() const {
+            return m_Generator.next();
+        }
+
+        const std::shared_ptr<std::vector<value_type> > &get() const {
+            if (!m_Cache) {
+                auto result = std::make_shared<std::vector<value_type> >();
+                while (auto item = m_Generator.next()) {
+                    result->push_back(std::move(*item));
+                }
+                m_Cache = std::move(result);
+            }
+            return m_Cache;
+        }
+
+        template<typename Wrapper, typename... Args>
+        auto chain(Args &&... args) && {
+            using NextGenerator = typename Wrapper::template type<Generator>;
+            return LazyRange<NextGenerator>(NextGenerator(std::move(m_Generator), std::forward<Args>(args)...));
+        }
+
+        template<typename Wrapper, typename... Args>
+        auto chain(Args &&... args) const & {
+            using NextGenerator = typename Wrapper::template type<Generator>;
+            return LazyRange<NextGenerator>(NextGenerator(m_Generator, std::forward<Args>(args)...));
+        }
+
+        // single pass input iterator, every increment pulls one element through the whole chain
+        class Iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = typename Generator::value_type;
+            using pointer = value_type *;
+            using reference = value_type &;
+
+        private:
+            const LazyRange *m_Range{};
+            std::optional<value_type> m_Current{};
+
+        public:
+            Iterator() = default;
+
+            explicit Iterator(const LazyRange *range) : m_Range(range), m_Current(range->next()) {}
+
+            reference operator*() {
+                return *m_Current;
+            }
+
+            pointer operator->() {
+                return &*m_Current;
+            }
+
+            Iterator &operator++() {
+                m_Current = m_Range->next();
+                return *this;
+            }
+
+            bool operator==(const Iterator &other) const {
+                return m_Current.has_value() == other.m_Current.has_value() && !m_Current.has_value();
+            }
+
+            bool operator!=(const Iterator &other) const {
+                return !(*this == other);
+            }
+        };
+
+        Iterator begin() const {
+            return Iterator{this};
+        }
+
+        Iterator end() const {
+            return Iterator{};
+        }
+    };
+
+    namespace Ranges {
+        template<typename T>
+        struct IsLazyRange : std::false_type {};
+
+        template<typename Generator>
+        struct IsLazyRange<LazyRange<Generator> > : std::true_type {};
+
+        template<typename T>
+        inline constexpr bool IsLazyRangeV = IsLazyRange<T>::value;
+
+        // stages with a pull based implementation (take, takeWhile) mark themselves with IsLazy and provide
+        // applyLazy(range); fusible element-wise stages are wrapped in a StageGeneratorOf
+        template<typename T, typename = void>
+        struct IsLazyStage : std::false_type {};
+
+        template<typename T>
+        struct IsLazyStage<T, std::enable_if_t<T::IsLazy> > : std::true_type {};
+
+        template<typename T>
+        inline constexpr bool IsLazyStageV = IsLazyStage<T>::value;
+
+        namespace Impl {
+            // pulls from anything with get(), the upstream is only evaluated on the first pull
+            template<typename Source>
+            class SourceGenerator {
+                Source m_Source;
+                std::shared_ptr<std::vector<typename Source::value_type> > m_Data{};
+                size_t m_Index{};
+
+            public:
+                using value_type = typename Source::value_type;
+
+                explicit SourceGenerator(Source source) : m_Source(std::move(source)) {}
+
+                std::optional<value_type> next() {
+                    if (!m_Data) {
+                        m_Data = m_Source.get();
+                    }
+                    if (m_Index >= m_Data->size()) {
+                        return std::nullopt;
+                    }
+                    return (*m_Data)[m_Index++];
+                }
+            };
+
+            // owns its elements, so they are moved out instead of copied
+            template<typename T>
+            class VectorGenerator {
+                std::vector<T> m_Data;
+                size_t m_Index{};
+
+            public:
+                using value_type = T;
+
+                explicit VectorGenerator(std::vector<T> data) : m_Data(std::move(data)) {}
+
+                std::optional<value_type> next() {
+                    if (m_Index >= m_Data.size()) {
+                        return std::nullopt;
+                    }
+                    return std::move(m_Data[m_Index++]);
+                }
+            };
+
+            // does not own the container it walks, like asRangeNoOwnership the container has to outlive the range
+            template<typename Iterator>
+            class IteratorGenerator {
+                Iterator m_Current;
+                Iterator m_End;
+
+            public:
+                using value_type = std::decay_t<decltype(*std::declval<Iterator>())>;
+
+                IteratorGenerator(Iterator begin, Iterator end) : m_Current(std::move(begin)), m_End(std::move(end)) {}
+
+                std::optional<value_type> next() {
+                    if (m_Current == m_End) {
+                        return std::nullopt;
+                    }
+                    return *m_Current++;
+                }
+            };
+
+            // F: () -> std::optional<T>, std::nullopt ends the range
+            template<typename F>
+            class FunctionGenerator {
+                F m_Function;
+
+            public:
+                using value_type = typename std::invoke_result_t<F &>::value_type;
+
+                explicit FunctionGenerator(F function) : m_Function(std::move(function)) {}
+
+                std::optional<value_type> next() {
+                    return std::invoke(m_Function);
+                }
+            };
+
+            template<typename Stage>
+            struct StageGeneratorOf {
+                template<typename Upstream>
+                class type {
+                    Upstream m_Upstream;
+                    Stage m_Stage;
+
+                public:
+                    using value_type = typename Stage::template Output<typename Upstream::value_type>;
+
+                    type(Upstream upstream, Stage stage) : m_Upstream(std::move(upstream)), m_Stage(std::move(stage)) {}
+
+                    std::optional<value_type> next() {
+                        std::optional<value_type> result;
+                        while (!result) {
+                            auto item = m_Upstream.next();
+                            if (!item) {
+                                break;
+                            }
+                            m_Stage.push(std::move(*item), [&result](auto &&output) {
+                                result.emplace(std::forward<decltype(output)>(output));
+                            });
+                        }
+                        return result;
+                    }
+                };
+            };
+
+            struct TakeGenerator {
+                template<typename Upstream>
+                class type {
+                    Upstream m_Upstream;
+                    size_t m_Remaining;
+
+                public:
+                    using value_type = typename Upstream::value_type;
+
+                    type(Upstream upstream, size_t count) : m_Upstream(std::move(upstream)), m_Remaining(count) {}
+
+                    std::optional<value_type> next() {
+                        if (!m_Remaining) {
+                            return std::nullopt;
+                        }
+                        --m_Remaining;
+                        return m_Upstream.next();
+                    }
+                };
+            };
+
+            template<typename Predicate>
+            struct TakeWhileGenerator {
+                template<typename Upstream>
+                class type {
+                    Upstream m_Upstream;
+                    Predicate m_Predicate;
+                    bool m_Done{};
+
+                public:
+                    using value_type = typename Upstream::value_type;
+
+                    type(Upstream upstream, Predicate predicate)
+                        : m_Upstream(std::move(upstream)), m_Predicate(std::move(predicate)) {}
+
+                    std::optional<value_type> next() {
+                        if (m_Done) {
+                            return std::nullopt;
+                        }
+                        auto item = m_Upstream.next();
+                        if (!item || !std::invoke(m_Predicate, *item)) {
+                            m_Done = true;
+                            return std::nullopt;
+                        }
+                        return item;
+                    }
+                };
+            };
+        }
+
+        // switches the rest of the pipeline to pull based evaluation
+        inline auto lazy() {
+            return [](auto &&source) {
+                using SourceType = std::decay_t<decltype(source)>;
+                if constexpr (IsLazyRangeV<SourceType>) {
+                    return std::forward<decltype(source)>(source);
+                } else if constexpr (IsRangeV<SourceType> || IsFusedRangeV<SourceType>) {
+                    return LazyRange<Impl::SourceGenerator<SourceType> >(
+                        Impl::SourceGenerator<SourceType>(std::forward<decltype(source)>(source)));
+                } else if constexpr (std::is_lvalue_reference_v<decltype(source)>) {
+                    using Generator = Impl::IteratorGenerator<decltype(std::begin(source))>;
+                    return LazyRange<Generator>(Generator(std::begin(source), std::end(source)));
+                } else {
+                    using T = typename SourceType::value_type;
+                    return LazyRange<Impl::VectorGenerator<T> >(Impl::VectorGenerator<T>(
+                        std::vector<T>(std::make_move_iterator(std::begin(source)),
+                                       std::make_move_iterator(std::end(source)))));
+                }
+            };
+        }
+
+        // a lazy source from a function returning std::optional<T>, std::nullopt ends the range
+        template<typename F>
+        auto generate(F &&function) {
+            using Generator = Impl::FunctionGenerator<std::decay_t<F> >;
+            return LazyRange<Generator>(Generator(std::forward<F>(function)));
+        }
+    }
+}
+
+template<typename Generator, typename Convertor>
+decltype(auto) operator|(WayLib::LazyRange<Generator> &&range, Convertor &&converter) {
+    using Stage = std::decay_t<Convertor>;
+    if constexpr (WayLib::Ranges::IsLazyStageV<Stage>) {
+        return converter.applyLazy(std::move(range));
+    } else if constexpr (WayLib::Ranges::IsFusibleStageV<Stage>) {
+        return std::move(range).template chain<WayLib::Ranges::Impl::StageGeneratorOf<Stage> >(
+            std::forward<Convertor>(converter));
+    } else {
+        return WayLib::Ranges::autoSync()(converter(std::move(range)));
+    }
+}
+
+template<typename Generator, typename Convertor>
+decltype(auto) operator|(const WayLib::LazyRange<Generator> &range, Convertor &&converter) {
+    using Stage = std::decay_t<Convertor>;
+    if constexpr (WayLib::Ranges::IsLazyStageV<Stage>) {
+        return converter.applyLazy(range);
+    } else if constexpr (WayLib::Ranges::IsFusibleStageV<Stage>) {
+        return range.template chain<WayLib::Ranges::Impl::StageGeneratorOf<Stage> >(
+            std::forward<Convertor>(converter));
+    } else {
+        return WayLib::Ranges::autoSync()(converter(range));
+    }
+}
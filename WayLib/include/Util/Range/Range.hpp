@@ -1,7 +1,10 @@
 #pragma once
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include "Util/ThreadPool.hpp"
+
 namespace WayLib {
     template<typename T>
     inline auto fakeDeleter() {
@@ -194,11 +197,11 @@ decltype(auto) operator|(const WayLib::Range<T, R> &range, Convertor &&converter
 template<typename T, typename F,
     std::void_t<decltype(std::is_invocable_v<F, std::vector<T> &&>)>* = nullptr>
 auto operator|(std::vector<T> &&vec, F &&converter) {
-    return converter(std::move(vec)) | WayLib::Ranges::autoSync();
+    return WayLib::Ranges::autoSync()(converter(std::move(vec)));
 }
 
 template<typename T, typename F,
     std::void_t<decltype(std::is_invocable_v<F, const std::vector<T> &>)>* = nullptr>
 auto operator|(const std::vector<T> &vec, F &&converter) {
-    return converter(vec) | WayLib::Ranges::autoSync();
+    return WayLib::Ranges::autoSync()(converter(vec));
 }
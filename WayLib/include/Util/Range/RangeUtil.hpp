@@ -3,6 +3,9 @@
 #include <optional>
 
 #include "Range.hpp"
+#include "FusedRange.hpp"
+#include "LazyRange.hpp"
+#include "Util/ThreadPool.hpp"
 #include "Util/TypeTraits.hpp"
 
 #include <vector>
@@ -88,6 +91,103 @@ namespace WayLib::Ranges {
         };
     }
 
+    // execution policy for the parallel overloads of map / filter / forEach / flatMap
+    struct ParallelPolicy {
+        ThreadPool *m_Pool;
+        size_t m_GrainSize;
+    };
+
+    inline ParallelPolicy parallel(ThreadPool &pool = ThreadPool::GlobalInstance(), size_t grainSize = 4096) {
+        return ParallelPolicy{&pool, std::max<size_t>(grainSize, 1)};
+    }
+
+    namespace Impl {
+        // an evaluated vector no other range or source shares, a stage may consume it instead of copying
+        template<typename T>
+        bool IsExclusive(const std::shared_ptr<std::vector<T> > &data) {
+            return data.use_count() == 1;
+        }
+
+        struct ChunkPlan {
+            size_t m_Count;
+            size_t m_Size;
+        };
+
+        // at least grainSize elements per chunk, and no more than a few chunks per worker
+        inline ChunkPlan PlanChunks(const ParallelPolicy &policy, size_t size) {
+            size_t count = std::min<size_t>((size + policy.m_GrainSize - 1) / policy.m_GrainSize,
+                                            4 * static_cast<size_t>(policy.m_Pool->getMaxThreads()));
+            if (count <= 1) {
+                return ChunkPlan{size ? 1u : 0u, size};
+            }
+            size_t chunkSize = (size + count - 1) / count;
+            return ChunkPlan{(size + chunkSize - 1) / chunkSize, chunkSize};
+        }
+
+        // runs body(chunkIndex, begin, end) for every chunk, the calling thread takes the first chunk itself and then
+        // helps the pool until every chunk is done; the first exception thrown by any chunk is rethrown here
+        template<typename Body>
+        void ParallelFor(const ParallelPolicy &policy, const ChunkPlan &plan, size_t size, Body &&body) {
+            std::vector<Future<void> > futures;
+            futures.reserve(plan.m_Count);
+            for (size_t i = 1; i < plan.m_Count; ++i) {
+                futures.push_back(policy.m_Pool->dispatch([&body, i, &plan, size] {
+                    body(i, i * plan.m_Size, std::min(size, (i + 1) * plan.m_Size));
+                }));
+            }
+
+            std::exception_ptr exception;
+            try {
+                if (plan.m_Count) {
+                    body(0, 0, std::min(size, plan.m_Size));
+                }
+            } catch (...) {
+                exception = std::current_exception();
+            }
+
+            for (auto &future: futures) {
+                while (!future.isReady() && policy.m_Pool->tryRunPendingTask()) {}
+                try {
+                    future.get();
+                } catch (...) {
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                }
+            }
+
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+
+        // every chunk fills its own vector through body(item, output), the pieces are then stitched in order
+        template<typename U, typename T, typename Body>
+        std::shared_ptr<std::vector<U> > ParallelCollect(const ParallelPolicy &policy, std::vector<T> &data,
+                                                         Body &&body) {
+            auto plan = PlanChunks(policy, data.size());
+            std::vector<std::vector<U> > pieces(plan.m_Count);
+            ParallelFor(policy, plan, data.size(), [&](size_t chunk, size_t begin, size_t end) {
+                auto &piece = pieces[chunk];
+                piece.reserve(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    body(data[i], piece);
+                }
+            });
+
+            size_t total{};
+            for (auto &piece: pieces) {
+                total += piece.size();
+            }
+
+            auto result = std::make_shared<std::vector<U> >();
+            result->reserve(total);
+            for (auto &piece: pieces) {
+                std::move(piece.begin(), piece.end(), std::back_inserter(*result));
+            }
+            return result;
+        }
+    }
 
     template<typename Collector>
     auto collect(Collector collector) {
@@ -96,18 +196,179 @@ namespace WayLib::Ranges {
         };
     }
 
+    namespace Impl {
+        // the sequential element-wise stages are named types rather than lambdas, so that a FusedRange can recognise
+        // them and merge them into a single loop; applied to a plain Range they behave exactly like any other stage
+
+        template<typename Visitor>
+        struct ForEachStage {
+            static constexpr bool IsFusible = true;
+            static constexpr bool KeepsSize = true;
+
+            Visitor m_Visitor;
+
+            template<typename In>
+            using Output = In;
+
+            template<typename Item, typename Next>
+            void push(Item &&item, Next &&next) const {
+                std::invoke(m_Visitor, item);
+                next(std::forward<Item>(item));
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+
+                return Range<T, ParentType>(
+                    std::forward<R>(range),
+                    [visitor = m_Visitor](auto &&range) {
+                        for (auto &item: *range.get()) {
+                            std::invoke(visitor, item);
+                        }
+
+                        return range.get();
+                    });
+            }
+        };
+
+        template<typename Predicate>
+        struct FilterStage {
+            static constexpr bool IsFusible = true;
+            static constexpr bool KeepsSize = false;
+
+            Predicate m_Predicate;
+
+            template<typename In>
+            using Output = In;
+
+            template<typename Item, typename Next>
+            void push(Item &&item, Next &&next) const {
+                if (std::invoke(m_Predicate, item)) {
+                    next(std::forward<Item>(item));
+                }
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+
+                return Range<T, ParentType>{
+                    std::forward<R>(range),
+                    [predicate = m_Predicate](auto &&range) -> std::shared_ptr<std::vector<T> > {
+                        auto &&data = range.get();
+                        auto &original = *data;
+                        if (!IsExclusive(data)) {
+                            // other ranges still read the parent's vector, keep it intact
+                            auto vec = std::make_shared<std::vector<T> >();
+                            vec->reserve(original.size());
+                            for (auto &item: original) {
+                                if (std::invoke(predicate, item)) {
+                                    vec->push_back(item);
+                                }
+                            }
+                            return vec;
+                        }
+                        size_t writeIdx{};
+                        for (size_t checkIdx{}; checkIdx < original.size(); ++checkIdx) {
+                            if (std::invoke(predicate, original[checkIdx])) {
+                                if (checkIdx != writeIdx)
+                                    original[writeIdx] = std::move(original[checkIdx]);
+                                ++writeIdx;
+                            }
+                        }
+                        original.erase(original.begin() + writeIdx, original.end());
+                        // nobody else owns the vector, compact it in place to avoid a copy
+                        return data;
+                    }
+                };
+            }
+        };
+
+        template<typename Transformer>
+        struct MapStage {
+            static constexpr bool IsFusible = true;
+            static constexpr bool KeepsSize = true;
+
+            Transformer m_Transformer;
+
+            template<typename In>
+            using Output = std::remove_reference_t<std::invoke_result_t<const Transformer &, In> >;
+
+            template<typename Item, typename Next>
+            void push(Item &&item, Next &&next) const {
+                next(std::invoke(m_Transformer, std::forward<Item>(item)));
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+                using U = std::remove_reference_t<std::invoke_result_t<const Transformer &, T> >;
+
+                if constexpr (!std::is_same_v<T, U>) {
+                    return Range<U, ParentType>{
+                        std::forward<R>(range),
+                        [transformer = m_Transformer](auto &&range) {
+                            std::shared_ptr<std::vector<U> > vec = std::make_shared<std::vector<U> >();
+
+                            auto &&data = range.get();
+                            vec->reserve(data->size());
+
+                            for (auto &item: *data.get()) {
+                                vec->push_back(std::invoke(transformer, item));
+                            }
+
+                            return vec;
+                        }
+                    };
+                } else {
+                    return Range<U, ParentType>{
+                        std::forward<R>(range),
+                        [transformer = m_Transformer](auto &&range) -> std::shared_ptr<std::vector<U> > {
+                            auto &&data = range.get();
+                            if (!IsExclusive(data)) {
+                                auto vec = std::make_shared<std::vector<U> >();
+                                vec->reserve(data->size());
+                                for (auto &item: *data) {
+                                    vec->push_back(std::invoke(transformer, item));
+                                }
+                                return vec;
+                            }
+                            for (auto &item: *data.get()) {
+                                item = std::invoke(transformer, std::move(item));
+                            }
+                            return data;
+                        }
+                    };
+                }
+            }
+        };
+    }
+
     template<typename Visitor>
     auto forEach(Visitor visitor) {
-        return [visitor = std::move(visitor)](auto &&range) {
+        return Impl::ForEachStage<Visitor>{std::move(visitor)};
+    }
+
+    template<typename Visitor>
+    auto forEach(Visitor visitor, ParallelPolicy policy) {
+        return [visitor = std::move(visitor), policy](auto &&range) {
             using T = typename std::decay_t<decltype(range)>::value_type;
             using ParentType = std::decay_t<decltype(range)>;
 
             return Range<T, ParentType>(
                 std::forward<decltype(range)>(range),
-                [visitor](auto &&range) {
-                    for (auto &item: *range.get()) {
-                        std::invoke(visitor, item);
-                    }
+                [visitor, policy](auto &&range) {
+                    auto &data = *range.get();
+                    Impl::ParallelFor(policy, Impl::PlanChunks(policy, data.size()), data.size(),
+                                      [&](size_t, size_t begin, size_t end) {
+                                          for (size_t i = begin; i < end; ++i) {
+                                              std::invoke(visitor, data[i]);
+                                          }
+                                      });
 
                     return range.get();
                 });
@@ -124,23 +385,29 @@ namespace WayLib::Ranges {
 
     template<typename Predicate>
     auto filter(Predicate predicate) {
-        return [predicate = std::move(predicate)](auto &&range) {
+        return Impl::FilterStage<Predicate>{std::move(predicate)};
+    }
+
+    template<typename Predicate>
+    auto filter(Predicate predicate, ParallelPolicy policy) {
+        return [predicate = std::move(predicate), policy](auto &&range) {
             using T = typename std::decay_t<decltype(range)>::value_type;
             using ParentType = std::decay_t<decltype(range)>;
 
             return Range<T, ParentType>{
                 std::forward<decltype(range)>(range),
-                [predicate](auto &&range) {
-                    auto originalRef = *range.get();
-                    size_t checkIdx{}, writeIdx{};
-                    for (; checkIdx < originalRef.size(); ++checkIdx) {
-                        if (std::invoke(predicate, originalRef[checkIdx])) {
-                            if (checkIdx != writeIdx)
-                                originalRef[writeIdx++] = std::move(originalRef[checkIdx]);
+                [predicate, policy](auto &&range) {
+                    auto &&data = range.get();
+                    bool exclusive = Impl::IsExclusive(data);
+                    return Impl::ParallelCollect<T>(policy, *data, [&](auto &item, std::vector<T> &output) {
+                        if (std::invoke(predicate, item)) {
+                            if (exclusive) {
+                                output.push_back(std::move(item));
+                            } else {
+                                output.push_back(item);
+                            }
                         }
-                    }
-                    // share the original vector, to avoid unnecessary copy
-                    return range.get();
+                    });
                 }
             };
         };
@@ -148,7 +415,12 @@ namespace WayLib::Ranges {
 
     template<typename Transformer>
     auto map(Transformer &&transformer) {
-        return [transformer = std::forward<Transformer>(transformer)](auto &&range) {
+        return Impl::MapStage<std::decay_t<Transformer> >{std::forward<Transformer>(transformer)};
+    }
+
+    template<typename Transformer>
+    auto map(Transformer &&transformer, ParallelPolicy policy) {
+        return [transformer = std::forward<Transformer>(transformer), policy](auto &&range) {
             using T = typename std::decay_t<decltype(range)>::value_type;
             using ParentType = std::decay_t<decltype(range)>;
             using U = std::remove_reference_t<std::invoke_result_t<decltype(transformer), T> >;
@@ -156,26 +428,29 @@ namespace WayLib::Ranges {
             if constexpr (!std::is_same_v<T, U>) {
                 return Range<U, ParentType>{
                     std::forward<decltype(range)>(range),
-                    [transformer](auto &&range) {
-                        std::shared_ptr<std::vector<U> > vec = std::make_shared<std::vector<U> >();
-
-                        auto &&data = range.get();
-
-                        for (auto &item: *data.get()) {
-                            vec->push_back(std::invoke(transformer, item));
-                        }
-
-                        return vec;
+                    [transformer, policy](auto &&range) {
+                        return Impl::ParallelCollect<U>(policy, *range.get(), [&](auto &item, std::vector<U> &output) {
+                            output.push_back(std::invoke(transformer, item));
+                        });
                     }
                 };
             } else {
                 return Range<U, ParentType>{
                     std::forward<decltype(range)>(range),
-                    [transformer](auto &&range) {
+                    [transformer, policy](auto &&range) -> std::shared_ptr<std::vector<U> > {
                         auto &&data = range.get();
-                        for (auto &item: *data.get()) {
-                            item = std::invoke(transformer, std::move(item));
+                        if (!Impl::IsExclusive(data)) {
+                            // the source is shared, transforming it in place would change it for everyone
+                            return Impl::ParallelCollect<U>(policy, *data, [&](auto &item, std::vector<U> &output) {
+                                output.push_back(std::invoke(transformer, item));
+                            });
                         }
+                        Impl::ParallelFor(policy, Impl::PlanChunks(policy, data->size()), data->size(),
+                                          [&](size_t, size_t begin, size_t end) {
+                                              for (size_t i = begin; i < end; ++i) {
+                                                  (*data)[i] = std::invoke(transformer, std::move((*data)[i]));
+                                              }
+                                          });
                         return data;
                     }
                 };
@@ -252,11 +527,14 @@ namespace WayLib::Ranges {
             return Range<T, ParentType>{
                 std::forward<decltype(range)>(range),
                 [other = std::make_shared<std::vector<T> >(std::move(content))](auto &&range) {
-                    auto data = *range.get();
+                    auto &&source = range.get();
+                    auto data = std::make_shared<std::vector<T> >();
+                    data->reserve(source->size() + other->size());
+                    data->insert(data->end(), source->begin(), source->end());
                     for (auto &item: *other) {
-                        data.push_back(std::move(item));
+                        data->push_back(std::move(item));
                     }
-                    return std::make_shared<std::vector<T> >(std::move(data));
+                    return data;
                 }
             };
         };
@@ -271,11 +549,14 @@ namespace WayLib::Ranges {
             return Range<T, ParentType>{
                 std::forward<decltype(range)>(range),
                 [items = std::move(items)](auto &&range) {
-                    auto data = *range.get();
+                    auto &&source = range.get();
+                    auto data = std::make_shared<std::vector<T> >();
+                    data->reserve(source->size() + std::tuple_size_v<std::decay_t<decltype(items)> >);
+                    data->insert(data->end(), source->begin(), source->end());
                     std::apply([&data](auto &&... items) {
-                        (data.push_back(std::forward<decltype(items)>(items)), ...);
+                        (data->push_back(std::forward<decltype(items)>(items)), ...);
                     }, items);
-                    return std::make_shared<std::vector<T> >(std::move(data));
+                    return data;
                 }
             };
         };
@@ -349,9 +630,8 @@ namespace WayLib::Ranges {
                 std::forward<decltype(range)>(range),
                 [separators = std::move(separators)](auto &&range) {
                     std::vector<std::vector<T> > result;
-                    auto data = *range.get();
                     std::vector<T> current;
-                    for (auto &item: data) {
+                    for (auto &item: *range.get()) {
                         bool found = false;
                         std::apply([&](auto &&... separators) {
                             ((found |= item == separators), ...);
@@ -363,7 +643,7 @@ namespace WayLib::Ranges {
                                 current.clear();
                             }
                         } else {
-                            current.push_back(std::move(item));
+                            current.push_back(item);
                         }
                     }
 
@@ -402,11 +682,100 @@ namespace WayLib::Ranges {
         };
     }
 
+    template<typename F>
+    inline auto flatMap(F &&f, ParallelPolicy policy) {
+        return [f = std::forward<F>(f), policy](auto &&range) {
+            using T = typename std::decay_t<decltype(range)>::value_type;
+            using ParentType = std::decay_t<decltype(range)>;
+
+            using U = typename std::invoke_result_t<F, T>::value_type;
+            return Range<U, ParentType>{
+                std::forward<decltype(range)>(range),
+                [f = std::move(f), policy](auto &&range) {
+                    return Impl::ParallelCollect<U>(policy, *range.get(), [&](auto &item, std::vector<U> &output) {
+                        auto result = std::invoke(f, item);
+                        for (auto &innerItem: result) {
+                            output.push_back(std::move(innerItem));
+                        }
+                    });
+                }
+            };
+        };
+    }
+
+    namespace Impl {
+        // on a LazyRange these stop pulling once they are done, on any other range they truncate the evaluated vector
+        struct TakeStage {
+            static constexpr bool IsLazy = true;
+
+            size_t m_Count;
+
+            template<typename R>
+            auto applyLazy(R &&range) const {
+                return std::forward<R>(range).template chain<TakeGenerator>(m_Count);
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+
+                return Range<T, ParentType>{
+                    std::forward<R>(range),
+                    [count = m_Count](auto &&range) {
+                        auto &&data = range.get();
+                        return std::make_shared<std::vector<T> >(
+                            data->begin(), data->begin() + std::min(count, data->size()));
+                    }
+                };
+            }
+        };
+
+        template<typename Predicate>
+        struct TakeWhileStage {
+            static constexpr bool IsLazy = true;
+
+            Predicate m_Predicate;
+
+            template<typename R>
+            auto applyLazy(R &&range) const {
+                return std::forward<R>(range).template chain<TakeWhileGenerator<Predicate> >(m_Predicate);
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+
+                return Range<T, ParentType>{
+                    std::forward<R>(range),
+                    [predicate = m_Predicate](auto &&range) {
+                        auto &&data = range.get();
+                        auto end = std::find_if_not(data->begin(), data->end(), [&](auto &item) {
+                            return std::invoke(predicate, item);
+                        });
+                        return std::make_shared<std::vector<T> >(data->begin(), end);
+                    }
+                };
+            }
+        };
+    }
+
+    inline auto take(size_t count) {
+        return Impl::TakeStage{count};
+    }
+
+    template<typename Predicate>
+    auto takeWhile(Predicate predicate) {
+        return Impl::TakeWhileStage<Predicate>{std::move(predicate)};
+    }
+
+    // walks the range itself rather than get(), so on a LazyRange nothing past the match is ever produced
     template<typename F>
     inline auto firstMatch(F &&f) {
         return [f = std::forward<F>(f)](auto &&range) {
             std::optional<typename std::remove_reference_t<decltype(range)>::value_type> result;
-            for (auto &item: *range.get()) {
+            for (auto &item: range) {
                 if (std::invoke(f, item)) {
                     result = item;
                     break;
@@ -0,0 +1,272 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LazyRange.hpp"
+#include "Util/FileSystem.hpp"
+#include "Util/MappedFile.hpp"
+
+// Streaming sources: every element is read from its stream when the pipeline pulls it, so peak memory is one read
+// chunk plus whatever the pipeline itself keeps. Terminate with drain() (or anything that walks the range) instead
+// of get() / collect, which would gather the whole stream into one vector.
+namespace WayLib::Ranges {
+    inline constexpr size_t DefaultStreamChunkSize = 64 * 1024;
+
+    namespace Impl {
+        // Reads the stream in blocks of chunkSize bytes and cuts lines out of the block, which is much cheaper than
+        // std::getline per line. The state is shared, copies of the generator continue from the same position.
+        class StreamLineGenerator {
+            struct State {
+                std::unique_ptr<std::istream> m_Owned{};
+                std::istream *m_Stream{};
+                std::vector<char> m_Buffer{};
+                size_t m_Begin{};
+                size_t m_End{};
+                bool m_Exhausted{};
+            };
+
+            std::shared_ptr<State> m_State;
+
+        public:
+            using value_type = std::string;
+
+            StreamLineGenerator(std::istream &stream, size_t chunkSize) : m_State(std::make_shared<State>()) {
+                m_State->m_Stream = &stream;
+                m_State->m_Buffer.resize(chunkSize ? chunkSize : DefaultStreamChunkSize);
+            }
+
+            StreamLineGenerator(std::unique_ptr<std::istream> stream, size_t chunkSize)
+                : StreamLineGenerator(*stream, chunkSize) {
+                m_State->m_Owned = std::move(stream);
+            }
+
+            std::optional<value_type> next() {
+                auto &state = *m_State;
+                std::string line;
+                bool any = false;
+                while (true) {
+                    const char *begin = state.m_Buffer.data() + state.m_Begin;
+                    size_t available = state.m_End - state.m_Begin;
+                    if (auto *newline = static_cast<const char *>(std::memchr(begin, '\n', available))) {
+                        line.append(begin, newline);
+                        state.m_Begin += newline - begin + 1;
+                        break;
+                    }
+                    line.append(begin, available);
+                    any |= available != 0;
+                    state.m_Begin = state.m_End = 0;
+
+                    if (!state.m_Exhausted) {
+                        state.m_Stream->read(state.m_Buffer.data(), static_cast<std::streamsize>(state.m_Buffer.size()));
+                        state.m_End = static_cast<size_t>(state.m_Stream->gcount());
+                        state.m_Exhausted = state.m_End == 0;
+                    }
+                    if (state.m_Exhausted) {
+                        // the last line may have no trailing newline
+                        if (!any) {
+                            return std::nullopt;
+                        }
+                        break;
+                    }
+                }
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                return line;
+            }
+        };
+
+        // Zero copy lines over a mapped file. The views point into the mapping, which lives as long as any copy of
+        // the generator, so they must not be kept past the pipeline that produced them. Pages that have been read
+        // are handed back to the OS every chunkSize bytes, so resident memory does not grow with the file.
+        class MappedLineGenerator {
+            std::shared_ptr<Utils::MappedFile> m_File;
+            size_t m_Offset{};
+            size_t m_Released{};
+            size_t m_ChunkSize;
+
+        public:
+            using value_type = std::string_view;
+
+            MappedLineGenerator(std::shared_ptr<Utils::MappedFile> file, size_t chunkSize)
+                : m_File(std::move(file)), m_ChunkSize(chunkSize ? chunkSize : DefaultStreamChunkSize) {
+                m_File->adviseSequential();
+            }
+
+            std::optional<value_type> next() {
+                size_t size = m_File->size();
+                if (m_Offset >= size) {
+                    return std::nullopt;
+                }
+                auto *begin = reinterpret_cast<const char *>(m_File->data()) + m_Offset;
+                auto *newline = static_cast<const char *>(std::memchr(begin, '\n', size - m_Offset));
+                size_t length = newline ? static_cast<size_t>(newline - begin) : size - m_Offset;
+                m_Offset += length + (newline ? 1 : 0);
+
+                if (m_Offset - m_Released >= m_ChunkSize) {
+                    // keep the current line resident, everything before it is done
+                    size_t lineStart = static_cast<size_t>(begin - reinterpret_cast<const char *>(m_File->data()));
+                    m_File->releasePages(m_Released, lineStart - m_Released);
+                    m_Released = lineStart;
+                }
+
+                if (length && begin[length - 1] == '\r') {
+                    --length;
+                }
+                return std::string_view(begin, length);
+            }
+        };
+
+        // Reader: (std::istream &) -> std::optional<T>, std::nullopt ends the range
+        template<typename Reader>
+        class StreamRecordGenerator {
+            std::shared_ptr<std::istream> m_Stream;
+            Reader m_Reader;
+
+        public:
+            using value_type = typename std::invoke_result_t<Reader &, std::istream &>::value_type;
+
+            StreamRecordGenerator(std::shared_ptr<std::istream> stream, Reader reader)
+                : m_Stream(std::move(stream)), m_Reader(std::move(reader)) {}
+
+            std::optional<value_type> next() {
+                if (!*m_Stream) {
+                    return std::nullopt;
+                }
+                return std::invoke(m_Reader, *m_Stream);
+            }
+        };
+
+        struct ChunkGenerator {
+            template<typename Upstream>
+            class type {
+                Upstream m_Upstream;
+                size_t m_ChunkSize;
+
+            public:
+                using value_type = std::vector<typename Upstream::value_type>;
+
+                type(Upstream upstream, size_t chunkSize) : m_Upstream(std::move(upstream)),
+                                                            m_ChunkSize(chunkSize ? chunkSize : 1) {}
+
+                std::optional<value_type> next() {
+                    value_type chunk;
+                    chunk.reserve(m_ChunkSize);
+                    while (chunk.size() < m_ChunkSize) {
+                        auto item = m_Upstream.next();
+                        if (!item) {
+                            break;
+                        }
+                        chunk.push_back(std::move(*item));
+                    }
+                    if (chunk.empty()) {
+                        return std::nullopt;
+                    }
+                    return chunk;
+                }
+            };
+        };
+
+        struct ChunkedStage {
+            static constexpr bool IsLazy = true;
+
+            size_t m_ChunkSize;
+
+            template<typename R>
+            auto applyLazy(R &&range) const {
+                return std::forward<R>(range).template chain<ChunkGenerator>(m_ChunkSize);
+            }
+
+            template<typename R>
+            auto operator()(R &&range) const {
+                using T = typename std::decay_t<R>::value_type;
+                using ParentType = std::decay_t<R>;
+
+                return Range<std::vector<T>, ParentType>{
+                    std::forward<R>(range),
+                    [chunkSize = m_ChunkSize ? m_ChunkSize : 1](auto &&range) {
+                        auto &&data = range.get();
+                        auto result = std::make_shared<std::vector<std::vector<T> > >();
+                        result->reserve((data->size() + chunkSize - 1) / chunkSize);
+                        for (size_t i = 0; i < data->size(); i += chunkSize) {
+                            result->emplace_back(data->begin() + i,
+                                                 data->begin() + std::min(i + chunkSize, data->size()));
+                        }
+                        return result;
+                    }
+                };
+            }
+        };
+    }
+
+    // lines of a stream the caller keeps alive, read chunkSize bytes at a time
+    inline auto lines(std::istream &stream, size_t chunkSize = DefaultStreamChunkSize) {
+        return LazyRange<Impl::StreamLineGenerator>(Impl::StreamLineGenerator(stream, chunkSize));
+    }
+
+    // lines of a file, the stream is opened here and closed with the last copy of the range
+    inline auto lines(const Utils::FileLocation &file, size_t chunkSize = DefaultStreamChunkSize) {
+        auto stream = std::make_unique<std::ifstream>(file.getPath(), std::ios::binary);
+        if (!stream->is_open()) {
+            throw FileIOException(std::string("Failed to open file: ") + file.getPath());
+        }
+        return LazyRange<Impl::StreamLineGenerator>(Impl::StreamLineGenerator(std::move(stream), chunkSize));
+    }
+
+    // lines of a memory mapped file as std::string_view, see MappedLineGenerator for how long they stay valid
+    inline auto mappedLines(const std::string &path, size_t chunkSize = DefaultStreamChunkSize) {
+        return LazyRange<Impl::MappedLineGenerator>(
+            Impl::MappedLineGenerator(std::make_shared<Utils::MappedFile>(path), chunkSize));
+    }
+
+    inline auto mappedLines(const Utils::FileLocation &file, size_t chunkSize = DefaultStreamChunkSize) {
+        return mappedLines(std::string(file.getPath()), chunkSize);
+    }
+
+    // one record per reader call, for binary or otherwise non line based formats
+    template<typename Reader>
+    auto records(std::istream &stream, Reader &&reader) {
+        using Generator = Impl::StreamRecordGenerator<std::decay_t<Reader> >;
+        return LazyRange<Generator>(Generator(std::shared_ptr<std::istream>(&stream, [](std::istream *) {}),
+                                              std::forward<Reader>(reader)));
+    }
+
+    template<typename Reader>
+    auto records(const Utils::FileLocation &file, Reader &&reader) {
+        auto stream = std::make_shared<std::ifstream>(file.getPath(), std::ios::binary);
+        if (!stream->is_open()) {
+            throw FileIOException(std::string("Failed to open file: ") + file.getPath());
+        }
+        using Generator = Impl::StreamRecordGenerator<std::decay_t<Reader> >;
+        return LazyRange<Generator>(Generator(std::move(stream), std::forward<Reader>(reader)));
+    }
+
+    // groups consecutive elements into vectors of chunkSize, so a whole chunk can go through a regular (or parallel)
+    // Range pipeline while only one chunk is held at a time
+    inline auto chunked(size_t chunkSize) {
+        return Impl::ChunkedStage{chunkSize};
+    }
+
+    // pulls a lazy range to the end without keeping anything, returns how many elements came out
+    inline auto drain() {
+        return [](auto &&range) -> size_t {
+            if constexpr (IsLazyRangeV<std::decay_t<decltype(range)> >) {
+                size_t count = 0;
+                while (range.next()) {
+                    ++count;
+                }
+                return count;
+            } else {
+                return range.get()->size();
+            }
+        };
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace WayLib::Impl {
+    template<typename Member>
+    struct MemberPointerTraits;
+
+    template<typename Class, typename Field>
+    struct MemberPointerTraits<Field Class::*> {
+        using ClassType = Class;
+        using FieldType = Field;
+    };
+
+    // one field listed in DeclWayLibSerializable: its member pointer and its byte offset inside the struct
+    template<auto Member, size_t FieldOffset>
+    struct SerializableField {
+        using Class = typename MemberPointerTraits<decltype(Member)>::ClassType;
+        using Type = typename MemberPointerTraits<decltype(Member)>::FieldType;
+
+        static constexpr size_t Offset = FieldOffset;
+
+        static const Type &get(const Class &object) {
+            return object.*Member;
+        }
+
+        static Type &get(Class &object) {
+            return object.*Member;
+        }
+    };
+}
+
+// Describes the fields DataBuffer serializes for a struct, in order. Use it inside the struct body:
+//     struct Message {
+//         int32_t id; uint32_t flags; std::string name;
+//         DeclWayLibSerializable(Message, id, flags, name)
+//     };
+// Adjacent trivially copyable fields without padding between them are written and read with one memcpy.
+// Field offsets come from offsetof, which GCC only warns about (-Winvalid-offsetof) for non standard layout structs.
+#define DeclWayLibSerializable(Type, ...) \
+    static constexpr auto WayLibSerializableFields() { \
+        return std::tuple<WayLibForEach(WayLibSerializableField, Type, __VA_ARGS__)>{}; \
+    }
+
+#define WayLibSerializableField(Type, field) ::WayLib::Impl::SerializableField<&Type::field, offsetof(Type, field)>
+
+// up to 32 fields, WayLibExpand keeps MSVC's traditional preprocessor from passing __VA_ARGS__ as one argument
+#define WayLibExpand(...) __VA_ARGS__
+#define WayLibConcat(a, b) WayLibConcatImpl(a, b)
+#define WayLibConcatImpl(a, b) a##b
+#define WayLibArgCount(...) WayLibExpand(WayLibArgCountImpl(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define WayLibArgCountImpl(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define WayLibForEach(Macro, Type, ...) \
+    WayLibExpand(WayLibConcat(WayLibForEach, WayLibArgCount(__VA_ARGS__))(Macro, Type, __VA_ARGS__))
+#define WayLibForEach1(Macro, Type, x) Macro(Type, x)
+#define WayLibForEach2(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach1(Macro, Type, __VA_ARGS__))
+#define WayLibForEach3(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach2(Macro, Type, __VA_ARGS__))
+#define WayLibForEach4(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach3(Macro, Type, __VA_ARGS__))
+#define WayLibForEach5(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach4(Macro, Type, __VA_ARGS__))
+#define WayLibForEach6(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach5(Macro, Type, __VA_ARGS__))
+#define WayLibForEach7(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach6(Macro, Type, __VA_ARGS__))
+#define WayLibForEach8(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach7(Macro, Type, __VA_ARGS__))
+#define WayLibForEach9(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach8(Macro, Type, __VA_ARGS__))
+#define WayLibForEach10(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach9(Macro, Type, __VA_ARGS__))
+#define WayLibForEach11(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach10(Macro, Type, __VA_ARGS__))
+#define WayLibForEach12(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach11(Macro, Type, __VA_ARGS__))
+#define WayLibForEach13(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach12(Macro, Type, __VA_ARGS__))
+#define WayLibForEach14(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach13(Macro, Type, __VA_ARGS__))
+#define WayLibForEach15(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach14(Macro, Type, __VA_ARGS__))
+#define WayLibForEach16(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach15(Macro, Type, __VA_ARGS__))
+#define WayLibForEach17(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach16(Macro, Type, __VA_ARGS__))
+#define WayLibForEach18(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach17(Macro, Type, __VA_ARGS__))
+#define WayLibForEach19(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach18(Macro, Type, __VA_ARGS__))
+#define WayLibForEach20(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach19(Macro, Type, __VA_ARGS__))
+#define WayLibForEach21(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach20(Macro, Type, __VA_ARGS__))
+#define WayLibForEach22(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach21(Macro, Type, __VA_ARGS__))
+#define WayLibForEach23(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach22(Macro, Type, __VA_ARGS__))
+#define WayLibForEach24(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach23(Macro, Type, __VA_ARGS__))
+#define WayLibForEach25(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach24(Macro, Type, __VA_ARGS__))
+#define WayLibForEach26(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach25(Macro, Type, __VA_ARGS__))
+#define WayLibForEach27(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach26(Macro, Type, __VA_ARGS__))
+#define WayLibForEach28(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach27(Macro, Type, __VA_ARGS__))
+#define WayLibForEach29(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach28(Macro, Type, __VA_ARGS__))
+#define WayLibForEach30(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach29(Macro, Type, __VA_ARGS__))
+#define WayLibForEach31(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach30(Macro, Type, __VA_ARGS__))
+#define WayLibForEach32(Macro, Type, x, ...) Macro(Type, x), WayLibExpand(WayLibForEach31(Macro, Type, __VA_ARGS__))
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace WayLib {
+    // A move-only void() callable. Callables up to InlineSize bytes are stored in place, so wrapping a small lambda
+    // never touches the heap, bigger ones fall back to a single allocation.
+    class Task {
+    public:
+        static constexpr size_t InlineSize = 48;
+
+        Task() = default;
+
+        template<typename F, std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>, void *>  = nullptr>
+        Task(F &&function) {
+            using Callable = std::decay_t<F>;
+            if constexpr (IsInline<Callable>) {
+                ::new(static_cast<void *>(m_Storage)) Callable(std::forward<F>(function));
+                m_Operations = &s_InlineOperations<Callable>;
+            } else {
+                ::new(static_cast<void *>(m_Storage)) Callable *(new Callable(std::forward<F>(function)));
+                m_Operations = &s_HeapOperations<Callable>;
+            }
+        }
+
+        Task(Task &&rhs) noexcept : m_Operations(rhs.m_Operations) {
+            if (m_Operations) {
+                m_Operations->move(m_Storage, rhs.m_Storage);
+                rhs.m_Operations = nullptr;
+            }
+        }
+
+        Task &operator=(Task &&rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                if (rhs.m_Operations) {
+                    rhs.m_Operations->move(m_Storage, rhs.m_Storage);
+                    m_Operations = rhs.m_Operations;
+                    rhs.m_Operations = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        Task(const Task &) = delete;
+
+        Task &operator=(const Task &) = delete;
+
+        ~Task() {
+            reset();
+        }
+
+        void operator()() {
+            m_Operations->invoke(m_Storage);
+        }
+
+        explicit operator bool() const {
+            return m_Operations;
+        }
+
+        void reset() {
+            if (m_Operations) {
+                m_Operations->destroy(m_Storage);
+                m_Operations = nullptr;
+            }
+        }
+
+    private:
+        struct Operations {
+            void (*invoke)(void *);
+
+            void (*move)(void *, void *) noexcept;
+
+            void (*destroy)(void *) noexcept;
+        };
+
+        template<typename Callable>
+        static constexpr bool IsInline = sizeof(Callable) <= InlineSize
+                                         && alignof(Callable) <= alignof(std::max_align_t)
+                                         && std::is_nothrow_move_constructible_v<Callable>;
+
+        template<typename Callable>
+        static constexpr Operations s_InlineOperations{
+            [](void *storage) {
+                (*static_cast<Callable *>(storage))();
+            },
+            [](void *to, void *from) noexcept {
+                ::new(to) Callable(std::move(*static_cast<Callable *>(from)));
+                static_cast<Callable *>(from)->~Callable();
+            },
+            [](void *storage) noexcept {
+                static_cast<Callable *>(storage)->~Callable();
+            }
+        };
+
+        template<typename Callable>
+        static constexpr Operations s_HeapOperations{
+            [](void *storage) {
+                (**static_cast<Callable **>(storage))();
+            },
+            [](void *to, void *from) noexcept {
+                ::new(to) Callable *(*static_cast<Callable **>(from));
+            },
+            [](void *storage) noexcept {
+                delete *static_cast<Callable **>(storage);
+            }
+        };
+
+        alignas(std::max_align_t) unsigned char m_Storage[InlineSize];
+        const Operations *m_Operations{};
+    };
+}
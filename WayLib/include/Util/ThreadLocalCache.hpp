@@ -0,0 +1,42 @@
+#pragma once
+
+namespace WayLib::Impl {
+    // A per-thread T for caches that must keep working while the thread (or the program) is shutting down.
+    // Get() returns the calling thread's instance, constructed on first use; Alive() turns false as soon as that
+    // instance starts being destroyed, and from then on code that runs from later thread local destructors must take
+    // its shared, uncached path instead of calling Get().
+    template<typename T>
+    class ThreadLocalCache {
+        struct Holder {
+            T m_Value;
+
+            ~Holder() {
+                Destroyed() = true;
+            }
+        };
+
+        // trivially destructible, so it can still be read while thread locals are being torn down
+        static bool &Destroyed() {
+            thread_local bool destroyed = false;
+            return destroyed;
+        }
+
+    public:
+        static T &Get() {
+            thread_local Holder holder;
+            return holder.m_Value;
+        }
+
+        static bool Alive() {
+            return !Destroyed();
+        }
+    };
+
+    // The process wide T, intentionally leaked: thread local caches may still hand things back to it during static
+    // destruction.
+    template<typename T>
+    T &LeakedSingleton() {
+        static auto *instance = new T;
+        return *instance;
+    }
+}
@@ -1,36 +1,82 @@
 #pragma once
+#include <algorithm>
 #include <mutex>
 #include <condition_variable>
-#include <future>
+#include <atomic>
 #include <memory>
-#include <queue>
 #include <thread>
+#include <tuple>
 #include <vector>
 #include <functional>
 
+#include "Future.hpp"
+#include "Task.hpp"
+
 namespace WayLib {
     class ThreadPool {
+        // every worker owns one of these, the pool itself owns one more for tasks submitted from outside
+        // the ring only ever grows, so once warmed up pushing and popping never allocates
+        struct alignas(64) TaskQueue {
+            std::mutex m_Mutex{};
+            std::vector<Task> m_Ring{};
+            size_t m_Head{};
+            size_t m_Size{};
+
+            [[nodiscard]] bool empty() const {
+                return !m_Size;
+            }
+
+            void pushBack(Task &&task) {
+                if (m_Size == m_Ring.size()) {
+                    std::vector<Task> ring(std::max<size_t>(64, m_Ring.size() * 2));
+                    for (size_t i = 0; i < m_Size; ++i) {
+                        ring[i] = std::move(m_Ring[(m_Head + i) & (m_Ring.size() - 1)]);
+                    }
+                    m_Ring.swap(ring);
+                    m_Head = 0;
+                }
+                m_Ring[(m_Head + m_Size++) & (m_Ring.size() - 1)] = std::move(task);
+            }
+
+            Task popBack() {
+                return std::move(m_Ring[(m_Head + --m_Size) & (m_Ring.size() - 1)]);
+            }
+
+            Task popFront() {
+                Task task = std::move(m_Ring[m_Head]);
+                m_Head = (m_Head + 1) & (m_Ring.size() - 1);
+                --m_Size;
+                return task;
+            }
+        };
+
+        struct WorkerContext {
+            ThreadPool *m_Pool{};
+            uint32_t m_Index{};
+        };
+
     public:
-        explicit ThreadPool(size_t maxThreads = 2 * std::thread::hardware_concurrency()) : m_MaxThreads(
-            std::min<uint32_t>(maxThreads, 256u)) {
+        explicit ThreadPool(size_t maxThreads = 2 * std::thread::hardware_concurrency(), bool workStealing = true)
+            : m_MaxThreads(std::min<uint32_t>(maxThreads, 256u)), m_WorkStealing(workStealing) {
+            m_Queues.reserve(m_MaxThreads);
+            for (uint32_t i = 0; i < m_MaxThreads; ++i) {
+                m_Queues.emplace_back(std::make_unique<TaskQueue>());
+            }
             m_Threads.reserve(m_MaxThreads);
             for (uint32_t i = 0; i < m_MaxThreads; ++i) {
-                m_Threads.emplace_back([this] {
+                m_Threads.emplace_back([this, i] {
+                    CurrentWorker() = WorkerContext{this, i};
                     while (!m_Stop) {
-                        std::function<void()> task; {
-                            std::unique_lock lock(m_Mutex);
-                            m_Condition.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
-                            if (m_Stop) {
-                                return;
-                            }
-                            if (m_Tasks.empty()) {
-                                // this should never reach
-                                continue;
-                            }
-                            task = std::move(m_Tasks.front());
-                            m_Tasks.pop();
+                        Task task;
+                        if (tryPop(i, task)) {
+                            task();
+                            continue;
                         }
-                        std::invoke(task);
+
+                        std::unique_lock lock(m_Mutex);
+                        ++m_Idle;
+                        m_Condition.wait(lock, [this] { return m_Stop || m_Pending > 0; });
+                        --m_Idle;
                     }
                 });
             }
@@ -38,7 +84,9 @@ namespace WayLib {
 
 
         void stop() {
-            m_Stop = true;
+            m_Stop = true; {
+                std::scoped_lock lock(m_Mutex);
+            }
             m_Condition.notify_all();
         }
 
@@ -53,29 +101,37 @@ namespace WayLib {
             return m_MaxThreads;
         }
 
+        bool isWorkStealing() const {
+            return m_WorkStealing;
+        }
+
         template<typename F, typename... Args>
         [[nodiscard]] auto dispatch(F &&function, Args &&... args) {
             using ReturnType = std::remove_reference_t<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>;
-            auto task = std::make_unique<std::packaged_task<ReturnType()> >(
-                std::bind(std::forward<F>(function), std::forward<Args>(args)...)
-            );
-            auto future = task->get_future();
-            {
-                std::unique_lock lock(m_Mutex);
-                m_Tasks.emplace(
-                    [inner = task.get()]() mutable {
-                        std::unique_ptr<std::packaged_task<ReturnType()> > task(inner);
-                        task->operator()();
+            auto [promise, future] = Promise<ReturnType>::Create();
+            submit(Task{
+                [promise = std::move(promise), function = std::forward<F>(function),
+                    arguments = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+                    promise.setResultOf([&]() -> ReturnType {
+                        return std::apply(std::move(function), std::move(arguments));
                     });
-            }
-            task.release();
-            m_Condition.notify_one();
-            return future;
+                }
+            });
+            return std::move(future);
         }
 
-        template<typename... Args>
-        void dispatchDetached(Args&&... args) {
-            dispatch(std::forward<decltype(args)>(args)...);
+        // no promise and no future, an exception thrown by the task is dropped just like an abandoned future would
+        template<typename F, typename... Args>
+        void dispatchDetached(F &&function, Args &&... args) {
+            submit(Task{
+                [function = std::forward<F>(function),
+                    arguments = std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...)]() mutable {
+                    try {
+                        std::apply(std::move(function), std::move(arguments));
+                    } catch (...) {
+                    }
+                }
+            });
         }
 
         template<typename... Args>
@@ -102,11 +158,85 @@ namespace WayLib {
             GlobalInstance().dispatchDetached(std::forward<decltype(args)>(args)...);
         }
 
+        // runs one queued task on the calling thread, so a thread waiting on results of this pool can help
+        // instead of blocking (and cannot deadlock the pool when it is itself a worker)
+        bool tryRunPendingTask() {
+            auto &context = CurrentWorker();
+            Task task;
+            if (!tryPop(context.m_Pool == this ? context.m_Index : m_MaxThreads, task)) {
+                return false;
+            }
+            task();
+            return true;
+        }
+
     private:
+        static WorkerContext &CurrentWorker() {
+            thread_local WorkerContext context{};
+            return context;
+        }
+
+        // tasks submitted by a worker of this pool stay on its own deque, everything else goes to the shared one
+        void submit(Task &&task) {
+            auto &context = CurrentWorker();
+            auto &queue = m_WorkStealing && context.m_Pool == this ? *m_Queues[context.m_Index] : m_Shared; {
+                std::scoped_lock lock(queue.m_Mutex);
+                queue.pushBack(std::move(task));
+            }
+            ++m_Pending;
+
+            // only pay for the wakeup when someone is actually sleeping
+            if (m_Idle > 0) {
+                {
+                    std::scoped_lock lock(m_Mutex);
+                }
+                m_Condition.notify_one();
+            }
+        }
+
+        // own deque from the back (LIFO, still hot in cache), then the shared queue, then steal from the front of others
+        // index == m_MaxThreads means the caller is not one of our workers and has no deque of its own
+        bool tryPop(uint32_t index, Task &task) {
+            if ((index < m_MaxThreads && popBack(*m_Queues[index], task)) || popFront(m_Shared, task)) {
+                return true;
+            }
+            for (uint32_t offset = 1; offset <= m_MaxThreads; ++offset) {
+                auto victim = (index + offset) % m_MaxThreads;
+                if (victim != index && popFront(*m_Queues[victim], task)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool popBack(TaskQueue &queue, Task &task) {
+            std::scoped_lock lock(queue.m_Mutex);
+            if (queue.empty()) {
+                return false;
+            }
+            task = queue.popBack();
+            --m_Pending;
+            return true;
+        }
+
+        bool popFront(TaskQueue &queue, Task &task) {
+            std::scoped_lock lock(queue.m_Mutex);
+            if (queue.empty()) {
+                return false;
+            }
+            task = queue.popFront();
+            --m_Pending;
+            return true;
+        }
+
         uint32_t m_MaxThreads;
+        bool m_WorkStealing;
         std::mutex m_Mutex{};
         std::condition_variable m_Condition{};
-        std::queue<std::function<void()> > m_Tasks{};
+        TaskQueue m_Shared{};
+        std::vector<std::unique_ptr<TaskQueue> > m_Queues{};
+        std::atomic<int64_t> m_Pending{0};
+        std::atomic<uint32_t> m_Idle{0};
         std::atomic<bool> m_Stop{false};
 
         std::vector<std::thread> m_Threads{};